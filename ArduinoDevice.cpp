@@ -57,7 +57,7 @@ qint64 ArduinoDevice::write(char direction, float distance, float speed) {
 }
 
 void ArduinoDevice::readSerialData() {
-    if (m_serialPort->canReadLine()) {
+    while (m_serialPort->canReadLine()) {  // Every complete line; readyRead may cover several
         QByteArray line = m_serialPort->readLine();
         QString data = QString::fromUtf8(line.trimmed()); // Convert to QString and remove any trailing newline
         //qDebug() << "Received:" << data;
@@ -0,0 +1,87 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef BOUNDEDQUEUE_H  // Include guard to prevent multiple inclusions
+#define BOUNDEDQUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Blocking FIFO with a fixed capacity, used to hand finished captures from the acquisition thread
+// to the consumers. push() waits while the queue is full so a slow consumer applies back-pressure
+// instead of growing memory; close() wakes every waiting thread and makes further pushes fail.
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity = 4) : maxSize(capacity ? capacity : 1) {}
+
+    // Waits up to timeout for room; returns false if the queue is full or closed
+    bool push(T item, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!notFull.wait_for(lock, timeout, [this] { return closed || items.size() < maxSize; }) || closed)
+        {
+            return false;
+        }
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Waits up to timeout for an item; returns false if none arrived (or the queue is closed and empty)
+    bool pop(T& item, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!notEmpty.wait_for(lock, timeout, [this] { return closed || !items.empty(); }) || items.empty())
+        {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    // Empties the queue and accepts pushes again
+    void reopen()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.clear();
+        closed = false;
+    }
+
+    bool isClosed() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return closed;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+
+private:
+    const size_t maxSize;
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<T> items;
+    bool closed = false;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -1,46 +1,372 @@
 #include "stdafx.h"
 #include "Calibration.h"
 #include "FUSMainWindow.h"
-#include <QEventLoop>
+#include "PulseMetrics.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
 
 Calibration::Calibration(Gantry* gantry, WaveformGenerator* waveformGenerator, PicoScope* picoScope, ArduinoDevice* Arduino, FUSMainWindow* fus_mainwindow, QObject* parent)
-    : QObject(parent), gantry(gantry), waveformGenerator(waveformGenerator), picoScope(picoScope), Arduino(Arduino), fus_mainwindow(fus_mainwindow)
+    : QObject(parent), gantry(gantry), waveformGenerator(waveformGenerator), picoScope(picoScope), Arduino(Arduino), fus_mainwindow(fus_mainwindow),
+    captureTimer(new QTimer(this)), moveTimer(new QTimer(this)), storeTimer(new QTimer(this))
 {
+    captureTimer->setSingleShot(true);
+    connect(captureTimer, &QTimer::timeout, this, &Calibration::onScanCaptureTimeout);
+    moveTimer->setSingleShot(true);
+    connect(moveTimer, &QTimer::timeout, this, &Calibration::onMoveTimeout);
+    storeTimer->setSingleShot(true);
+    connect(storeTimer, &QTimer::timeout, this, &Calibration::onStoreTimeout);
+    if (Arduino)
+    {
+        connect(Arduino, &ArduinoDevice::gantryReady, this, &Calibration::onGantryReady);
+    }
+    if (picoScope)
+    {
+        connect(picoScope, &PicoScope::scanCaptureReady, this, &Calibration::onScanCapture);
+        connect(picoScope, &PicoScope::scanRecordStored, this, &Calibration::onScanRecordStored);
+    }
 }
 
 Calibration::~Calibration()
 {
 }
 
+// Starts the scan and returns; the gantry and scope signals drive it point by point:
+//   gantryReady at N -> request a capture read out after the arrival -> capture N in memory
+//   -> hand record N to the writer threads (.bin, NPY/MAT), then issue the move to N + 1
+// so the move to the next point overlaps the conversion and file I/O of the last one. While the writers
+// hold maxScanRecordsPending records the move waits for one to be stored; no record is ever dropped.
 void Calibration::scan3DVolume()
 {
-    // Define the 3D volume bounds and step size
-    int xMax = 10, yMax = 10, zMax = 10;
-    int stepSize = 1;
+    if (scanning)
+    {
+        fus_mainwindow->emitPrintSignal("A scan is already running.");
+        return;
+    }
+
+    // Volume, steps and path order from the UI
+    const ScanPlan plan = fus_mainwindow->getScanPlan();
+    std::string error;
+    if (!plan.valid(error))
+    {
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("Scan not started: " + error));
+        return;
+    }
+    scanMode = ScanMode::Grid;
+    scanPath = plan.path();
+    fus_mainwindow->emitPrintSignal(QString("Scanning %1 points, %2 mm of travel").arg(scanPath.size()).arg(plan.travelMm(), 0, 'f', 1));
+
+    // Preallocate the NPY/MAT exports for this grid
+    picoScope->setScanGrid(plan.grid());
+
+    startScan();
+}
+
+// The scan plan is the coarse grid; the search then measures only around its maximum (FocusSearch). The
+// captures go to the .bin file with their positions; the NPY/MAT exports need a full grid and are skipped.
+void Calibration::findFocus()
+{
+    if (scanning)
+    {
+        fus_mainwindow->emitPrintSignal("A scan is already running.");
+        return;
+    }
+
+    const ScanPlan plan = fus_mainwindow->getScanPlan();
+    std::string error;
+    if (!focusSearch.start(plan, fus_mainwindow->getFocusResolutionValue(), error))
+    {
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("Focus search not started: " + error));
+        return;
+    }
+    scanMode = ScanMode::Focus;
+    focusMetricIndex = fus_mainwindow->getFocusMetricValue();
+    fus_mainwindow->emitPrintSignal(QString("Focus search: %1 coarse points, refined to %2 mm")
+        .arg(plan.points()).arg(fus_mainwindow->getFocusResolutionValue(), 0, 'f', 1));
+
+    startScan();
+}
+
+void Calibration::startScan()
+{
+    int32_t first[3];
+    if (scanMode == ScanMode::Grid ? scanPath.empty() : !focusSearch.next(first))
+    {
+        fus_mainwindow->emitPrintSignal("Nothing to scan.");
+        return;
+    }
+    if (scanMode == ScanMode::Grid)
+    {
+        std::copy(scanPath[0].position, scanPath[0].position + 3, first);
+    }
 
     // Generate a pulse
     generatePulse();
 
-    for (int x = 0; x <= xMax; x += stepSize)
+    // Captures come from a continuous acquisition; one the user already runs is used as it is
+    scanStartedAcquisition = false;
+    if (!picoScope->isAcquiring() && !picoScope->isStreaming())
     {
-        for (int y = 0; y <= yMax; y += stepSize)
+        picoScope->startAcquisition(0);
+        scanStartedAcquisition = true;
+    }
+
+    moveTimes.clear();
+    captureTimes.clear();
+    queueTimes.clear();
+    pointTimes.clear();
+    gantryAt[0] = (int32_t)std::lround(gantry->gantryPosition.x * ScanPlan::micrometresPerMm);
+    gantryAt[1] = (int32_t)std::lround(gantry->gantryPosition.y * ScanPlan::micrometresPerMm);
+    gantryAt[2] = (int32_t)std::lround(gantry->gantryPosition.z * ScanPlan::micrometresPerMm);
+    scanning = true;
+    scanIndex = 0;
+    scanStart = std::chrono::steady_clock::now();
+    lastCapture = scanStart;
+    emit scanStateChanged(true);
+    moveToPoint(first);
+}
+
+void Calibration::stopScan()
+{
+    if (!scanning)
+    {
+        return;
+    }
+    gantry->stop_Click();  // Drops the queued moves and halts the motors
+    finishScan("stopped by the user");
+}
+
+// Move to the next position; on a serpentine path that is one step along one axis
+void Calibration::moveToPoint(const int32_t position[3])
+{
+    std::copy(position, position + 3, scanTarget);
+    scanStage = ScanStage::Moving;
+    moveIssued = std::chrono::steady_clock::now();
+    int64_t travel = 0;  // um
+    for (int axis = 0; axis < 3; axis++)
+    {
+        travel += std::abs((int64_t)scanTarget[axis] - gantryAt[axis]);
+    }
+    if (!moveBy(gantryAt, scanTarget))
+    {
+        QTimer::singleShot(0, this, &Calibration::onGantryReady);  // Already there
+        return;
+    }
+    // gantryReady may never come (older firmware, a lost serial line); generous for the slowest moves
+    moveTimer->start((int)(std::min)((int64_t)INT_MAX, 10000 + travel * 2));  // 10 s plus 2 s per mm
+}
+
+void Calibration::onMoveTimeout()
+{
+    if (!scanning || scanStage != ScanStage::Moving)
+    {
+        return;
+    }
+    gantry->stop_Click();
+    finishScan(QString("the gantry did not report ready within %1 s of the move to point %2")
+        .arg(std::chrono::duration<double>(std::chrono::steady_clock::now() - moveIssued).count(), 0, 'f', 0).arg(scanIndex));
+}
+
+void Calibration::onGantryReady()
+{
+    if (!scanning || scanStage != ScanStage::Moving)
+    {
+        return;
+    }
+    moveTimer->stop();
+    gantryArrived = std::chrono::steady_clock::now();
+    moveTimes.record(gantryArrived - moveIssued);
+    scanStage = ScanStage::Capturing;
+    if (!picoScope->isAcquiring())
+    {
+        onScanCapture(picoScope->currentCapture());  // No acquisition running: the plotted capture, as before
+        return;
+    }
+    picoScope->requestScanCapture(gantryArrived);  // Only a capture read out after the arrival is taken
+    captureTimer->start(5000);
+}
+
+void Calibration::onScanCaptureTimeout()
+{
+    if (!scanning || scanStage != ScanStage::Capturing)
+    {
+        return;
+    }
+    picoScope->cancelScanCapture();
+    fus_mainwindow->emitPrintSignal(QString("No capture within 5 s at point %1; storing the last one").arg(scanIndex));
+    onScanCapture(picoScope->currentCapture());
+}
+
+void Calibration::onScanCapture(const PicoCapture& capture)
+{
+    if (!scanning || scanStage != ScanStage::Capturing)
+    {
+        return;  // A late answer to a cancelled request
+    }
+    captureTimer->stop();
+    const auto captured = std::chrono::steady_clock::now();
+    captureTimes.record(captured - gantryArrived);
+    pointTimes.record(captured - lastCapture);
+    lastCapture = captured;
+
+    // Record N is queued, not stored, before the gantry leaves for the next point; the focus search picks
+    // the next point from this capture's metric, which takes microseconds
+    int32_t point[3];
+    std::copy(scanTarget, scanTarget + 3, point);
+    scanIndex++;
+    int32_t nextPoint[3];
+    bool last;
+    if (scanMode == ScanMode::Focus)
+    {
+        focusSearch.report(point, focusMetric(capture));
+        last = !focusSearch.next(nextPoint);
+    }
+    else
+    {
+        last = scanIndex == scanPath.size();
+        if (!last)
+        {
+            std::copy(scanPath[scanIndex].position, scanPath[scanIndex].position + 3, nextPoint);
+        }
+    }
+
+    // Record data
+    if (!recordData(point[0], point[1], point[2], capture))
+    {
+        finishScan(QString("storage failed: point %1 was not recorded").arg(scanIndex - 1));
+        return;
+    }
+    queueTimes.record(std::chrono::steady_clock::now() - captured);
+
+    if (last)
+    {
+        finishScan();
+        return;
+    }
+    std::copy(nextPoint, nextPoint + 3, scanTarget);
+    if (picoScope->scanRecordsPending() >= PicoScope::maxScanRecordsPending)
+    {
+        scanStage = ScanStage::Storing;  // onScanRecordStored moves on
+        storeTimer->start(30000);
+        return;
+    }
+    moveToPoint(nextPoint);
+}
+
+void Calibration::onScanRecordStored(bool written)
+{
+    if (!scanning)
+    {
+        return;
+    }
+    if (!written)
+    {
+        gantry->stop_Click();
+        finishScan("storage failed");
+        return;
+    }
+    if (scanStage == ScanStage::Storing && picoScope->scanRecordsPending() < PicoScope::maxScanRecordsPending)
+    {
+        storeTimer->stop();
+        const int32_t next[3] = { scanTarget[0], scanTarget[1], scanTarget[2] };
+        moveToPoint(next);
+    }
+}
+
+void Calibration::onStoreTimeout()
+{
+    if (!scanning || scanStage != ScanStage::Storing)
+    {
+        return;
+    }
+    finishScan(QString("storage failed: no record stored within 30 s, %1 waiting").arg(picoScope->scanRecordsPending()));
+}
+
+void Calibration::finishScan(const QString& stoppedReason)
+{
+    scanning = false;
+    scanStage = ScanStage::Idle;
+    captureTimer->stop();
+    moveTimer->stop();
+    storeTimer->stop();
+    picoScope->cancelScanCapture();
+    if (scanStartedAcquisition)
+    {
+        picoScope->stopAcquisition();
+    }
+    picoScope->closeScanData();  // Every point and the index on disk before the scan is reported done
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - scanStart).count();
+    if (!stoppedReason.isEmpty())
+    {
+        fus_mainwindow->emitPrintSignal("Scan stopped: " + stoppedReason);
+    }
+    fus_mainwindow->emitPrintSignal(QString("Scan %1: %2 points in %3 s (%4 ms per point)").arg(stoppedReason.isEmpty() ? "done" : "ended")
+        .arg(scanIndex).arg(seconds, 0, 'f', 1).arg(scanIndex == 0 ? 0.0 : seconds * 1000 / scanIndex, 0, 'f', 1));
+    if (scanMode == ScanMode::Focus)
+    {
+        const FocusSearch::Result result = focusSearch.result();
+        const double mm = ScanPlan::micrometresPerMm;
+        fus_mainwindow->emitPrintSignal(QString("Focus at (%1, %2, %3) mm, %4 %5 mV; %6 points instead of %7 on a full grid")
+            .arg(result.focus[0] / mm, 0, 'f', 1).arg(result.focus[1] / mm, 0, 'f', 1).arg(result.focus[2] / mm, 0, 'f', 1)
+            .arg(focusMetricIndex == 0 ? "peak negative" : "RMS").arg(result.peak, 0, 'f', 1)
+            .arg(result.points).arg(result.densePoints));
+        for (int axis = 0; axis < 3; axis++)
         {
-            for (int z = 0; z <= zMax; z += stepSize)
+            if (result.hasLower[axis] && result.hasUpper[axis])
+            {
+                fus_mainwindow->emitPrintSignal(QString("  %1: -6 dB from %2 to %3 mm, width %4 mm").arg(ScanPlan::axisName(axis))
+                    .arg(result.lower[axis] / mm, 0, 'f', 2).arg(result.upper[axis] / mm, 0, 'f', 2)
+                    .arg((result.upper[axis] - result.lower[axis]) / mm, 0, 'f', 2));
+            }
+            else if (result.hasLower[axis] || result.hasUpper[axis])
             {
-                QEventLoop loop;
-                connect(Arduino, &ArduinoDevice::gantryReady, &loop, &QEventLoop::quit);
-                
-                // Move to the next position
-                gantry->move_Click('R', x, 5); // Example command, adjust as necessary
-                gantry->move_Click('F', y, 5);
-                gantry->move_Click('U', z, 5);
-
-                loop.exec(); // Wait here until gantryReady is emitted
-                // Record data
-                recordData(x, y, z);
+                fus_mainwindow->emitPrintSignal(QString("  %1: -6 dB %2 at %3 mm, the other side is outside the scan volume").arg(ScanPlan::axisName(axis))
+                    .arg(result.hasLower[axis] ? "below" : "above").arg((result.hasLower[axis] ? result.lower[axis] : result.upper[axis]) / mm, 0, 'f', 2));
             }
         }
     }
+    for (const LatencyHistogram* stage : { &moveTimes, &captureTimes, &queueTimes, &pointTimes })
+    {
+        fus_mainwindow->emitPrintSignal(QString::fromStdString(stage->toString()));
+    }
+    emit scanStateChanged(false);
+}
+
+// Moves the gantry from current to target (um) with relative moves along the axes that differ and updates
+// current; false if the gantry is already there
+bool Calibration::moveBy(int32_t current[3], const int32_t target[3])
+{
+    const char positive[3] = { 'R', 'F', 'U' };
+    const char negative[3] = { 'L', 'B', 'D' };
+    const float maxMoveMm = 100;  // ArduinoDevice::write clamps longer distances
+    bool moved = false;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const int32_t delta = target[axis] - current[axis];
+        float remaining = std::abs(delta) / (float)ScanPlan::micrometresPerMm;
+        while (remaining > 0.05f)  // The gantry resolves 0.1 mm
+        {
+            const float distance = (std::min)(remaining, maxMoveMm);
+            gantry->move_Click(delta > 0 ? positive[axis] : negative[axis], distance, 5);
+            remaining -= distance;
+            moved = true;
+        }
+        current[axis] = target[axis];
+    }
+    return moved;
+}
+
+// Peak negative pressure (the deepest excursion below the trace mean) or the RMS of channel A, in mV
+double Calibration::focusMetric(const PicoCapture& capture) const
+{
+    if (!capture.hasChannel(0) || capture.size() == 0)
+    {
+        return 0;
+    }
+    const PulseMetrics::Summary summary = PulseMetrics::summarize(capture.samples(0), capture.size());
+    const double counts = focusMetricIndex == 0 ? summary.mean() - summary.minimum : summary.rms();
+    return counts * capture.mvPerCount(0);
 }
 
 void Calibration::generatePulse()
@@ -48,7 +374,7 @@ void Calibration::generatePulse()
     fus_mainwindow->Calibration_Pulse();
 }
 
-void Calibration::recordData(int x, int y, int z)
+bool Calibration::recordData(int x, int y, int z, const PicoCapture& capture)
 {
-    picoScope->writePicoDataToBinaryFile(x,y,z);
+    return picoScope->writeScanCapture(x, y, z, capture);
 }
\ No newline at end of file
@@ -6,9 +6,15 @@
 #include <QString>
 #include <QFile>
 #include <QTextStream>
+#include <QTimer>
+#include <chrono>
+#include <vector>
 #include "Gantry.h"
 #include "WaveformGenerator.h"
 #include "PicoScope.h"
+#include "ScanPlan.h"
+#include "FocusSearch.h"
+#include "LatencyHistogram.h"
 
 class FUSMainWindow;
 
@@ -25,7 +31,21 @@ public:
         QObject* parent = nullptr);
     ~Calibration();  // Destructor
     
-    void scan3DVolume();
+    void scan3DVolume();  // Starts the scan of the UI scan plan; returns while it runs
+    void findFocus();  // Starts an adaptive focus search over the UI scan plan; returns while it runs
+    void stopScan();  // Stops the gantry and ends the running scan, keeping the points recorded so far
+    bool isScanning() const { return scanning; }
+
+signals:
+    void scanStateChanged(bool running);  // A scan or focus search started or ended
+
+private slots:
+    void onGantryReady();  // The gantry has reached scanTarget
+    void onScanCapture(const PicoCapture& capture);  // A capture taken at scanTarget
+    void onScanCaptureTimeout();  // No capture after the gantry arrived
+    void onMoveTimeout();  // No gantryReady after a move
+    void onScanRecordStored(bool written);  // A record left the PicoScope hand-off
+    void onStoreTimeout();  // The hand-off stayed full
 
 private:
     Gantry* gantry;
@@ -36,7 +56,48 @@ private:
 
     //void moveToNextPosition(int& x, int& y, int& z);
     void generatePulse();
-    void recordData(int x, int y, int z);
+    bool recordData(int x, int y, int z, const PicoCapture& capture);  // False if the record was refused
+    bool moveBy(int32_t current[3], const int32_t target[3]);  // Relative moves from current to target (um)
+    void startScan();  // Pulse, acquisition and timers; the caller has set up scanPath or focusSearch
+    void moveToPoint(const int32_t position[3]);  // Issues the move to position (um)
+    double focusMetric(const PicoCapture& capture) const;  // Of channel A, in mV
+    void finishScan(const QString& stoppedReason = QString());  // Closes the data; a reason marks a scan that did not complete
+
+    // Scan pipeline: the move to point N + 1 is issued as soon as the capture at point N is in hand and queued,
+    // and record N is written by the PicoScope writer threads while the gantry travels
+    enum class ScanStage
+    {
+        Idle,
+        Moving,  // Waiting for gantryReady
+        Capturing,  // Waiting for a capture read out after the gantry arrived
+        Storing  // Waiting for the writers to take a record before the move to scanTarget
+    };
+    enum class ScanMode
+    {
+        Grid,  // Every point of scanPath
+        Focus  // The points focusSearch asks for
+    };
+    ScanMode scanMode = ScanMode::Grid;
+    std::vector<ScanPoint> scanPath;
+    FocusSearch focusSearch;
+    int focusMetricIndex = 0;  // 0 peak negative, 1 RMS
+    int32_t scanTarget[3] = { 0, 0, 0 };  // um, the point being moved to or captured
+    size_t scanIndex = 0;  // Points captured
+    int32_t gantryAt[3] = { 0, 0, 0 };  // um, where the issued moves leave the gantry
+    bool scanning = false;
+    ScanStage scanStage = ScanStage::Idle;
+    bool scanStartedAcquisition = false;  // The scan started a continuous acquisition and stops it at the end
+    QTimer* captureTimer;
+    QTimer* moveTimer;
+    QTimer* storeTimer;
+    std::chrono::steady_clock::time_point scanStart;
+    std::chrono::steady_clock::time_point moveIssued;
+    std::chrono::steady_clock::time_point gantryArrived;
+    std::chrono::steady_clock::time_point lastCapture;
+    LatencyHistogram moveTimes{ "Move (issued to gantry ready)" };
+    LatencyHistogram captureTimes{ "Capture (gantry ready to capture in memory)" };
+    LatencyHistogram queueTimes{ "Record hand-off (capture to record queued)" };
+    LatencyHistogram pointTimes{ "Point (capture to next capture)" };
 };
 
 #endif // CALIBRATION_H
\ No newline at end of file
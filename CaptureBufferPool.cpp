@@ -0,0 +1,158 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+// Built without the precompiled header so that ScopeBenchmark can share it without Qt
+#include "CaptureBufferPool.h"
+#include <algorithm>
+#include <new>
+
+CaptureBufferPool::CaptureBufferPool(size_t alignment) : state(std::make_shared<State>())
+{
+    state->alignment = alignment;
+}
+
+CaptureBufferPool::~CaptureBufferPool()
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    for (CaptureBuffer* buffer : state->freeBuffers)
+    {
+        destroy(buffer);
+    }
+    state->freeBuffers.clear();
+    // Buffers still held by consumers are freed by their deleters once the state is gone
+}
+
+bool CaptureBufferPool::configure(size_t samplesPerBuffer, uint32_t channelMask)
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (samplesPerBuffer == state->length && channelMask == state->channelMask)
+    {
+        return false;
+    }
+    for (CaptureBuffer* buffer : state->freeBuffers)
+    {
+        destroy(buffer);
+        state->allocated--;
+    }
+    state->freeBuffers.clear();
+    state->registered.clear();
+    state->length = samplesPerBuffer;
+    state->channelMask = channelMask;
+    state->generation++;  // Outstanding buffers of the old size are freed instead of recycled
+    return true;
+}
+
+std::shared_ptr<CaptureBuffer> CaptureBufferPool::acquire(const CaptureBuffer* preferred)
+{
+    CaptureBuffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        auto found = std::find(state->freeBuffers.begin(), state->freeBuffers.end(), preferred);
+        if (preferred && found != state->freeBuffers.end())
+        {
+            buffer = *found;
+            state->freeBuffers.erase(found);
+        }
+        else if (!state->freeBuffers.empty())
+        {
+            buffer = state->freeBuffers.back();  // Most recently used, most likely still in cache
+            state->freeBuffers.pop_back();
+        }
+        else
+        {
+            buffer = new CaptureBuffer();
+            buffer->length = state->length;
+            buffer->alignment = state->alignment;
+            buffer->generation = state->generation;
+            buffer->samples = static_cast<int16_t*>(::operator new[]((std::max)(state->length, (size_t)1) * sizeof(int16_t), std::align_val_t(state->alignment)));
+            state->allocated++;
+        }
+    }
+
+    std::weak_ptr<State> weakState = state;
+    return std::shared_ptr<CaptureBuffer>(buffer, [weakState](CaptureBuffer* released) { release(weakState, released); });
+}
+
+bool CaptureBufferPool::needsRegistration(int segment, int channel, const CaptureBuffer* buffer)
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (segment < 0 || channel < 0)
+    {
+        return true;
+    }
+    if ((size_t)segment >= state->registered.size())
+    {
+        state->registered.resize(segment + 1);
+    }
+    std::vector<const CaptureBuffer*>& channels = state->registered[segment];
+    if ((size_t)channel >= channels.size())
+    {
+        channels.resize(channel + 1, nullptr);
+    }
+    if (channels[channel] == buffer)
+    {
+        return false;
+    }
+    channels[channel] = buffer;
+    return true;
+}
+
+const CaptureBuffer* CaptureBufferPool::registeredBuffer(int segment, int channel) const
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (segment < 0 || channel < 0 || (size_t)segment >= state->registered.size() || (size_t)channel >= state->registered[segment].size())
+    {
+        return nullptr;
+    }
+    return state->registered[segment][channel];
+}
+
+void CaptureBufferPool::invalidateRegistrations()
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->registered.clear();
+}
+
+size_t CaptureBufferPool::bufferLength() const
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->length;
+}
+
+size_t CaptureBufferPool::allocatedCount() const
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->allocated;
+}
+
+size_t CaptureBufferPool::freeCount() const
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->freeBuffers.size();
+}
+
+void CaptureBufferPool::release(const std::weak_ptr<State>& weakState, CaptureBuffer* buffer)
+{
+    std::shared_ptr<State> owner = weakState.lock();
+    if (!owner)
+    {
+        destroy(buffer);  // The pool has already been destroyed
+        return;
+    }
+    std::lock_guard<std::mutex> lock(owner->mutex);
+    if (buffer->generation != owner->generation)
+    {
+        destroy(buffer);  // Allocated for an older configuration
+        owner->allocated--;
+        return;
+    }
+    owner->freeBuffers.push_back(buffer);
+}
+
+void CaptureBufferPool::destroy(CaptureBuffer* buffer)
+{
+    ::operator delete[](buffer->samples, std::align_val_t(buffer->alignment));
+    delete buffer;
+}
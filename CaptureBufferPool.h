@@ -0,0 +1,79 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef CAPTUREBUFFERPOOL_H  // Include guard to prevent multiple inclusions
+#define CAPTUREBUFFERPOOL_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// One aligned buffer of raw ADC samples owned by a CaptureBufferPool
+class CaptureBuffer
+{
+public:
+    int16_t* data() { return samples; }
+    const int16_t* data() const { return samples; }
+    size_t size() const { return length; }
+
+private:
+    friend class CaptureBufferPool;
+    int16_t* samples = nullptr;
+    size_t length = 0;
+    size_t alignment = 64;
+    uint64_t generation = 0;  // Pool configuration the buffer was allocated for
+};
+
+// Pool of persistent, cache-line aligned capture buffers.
+// acquire() hands out a shared_ptr; when the last consumer releases it the buffer goes back to the pool
+// instead of being freed, so repeated captures of the same size do not allocate or page-fault.
+// The pool also remembers which buffer is registered with the driver for each memory segment and channel, and
+// hands that buffer out again when it is free, so a buffer is only registered again when a consumer still holds
+// the registered one or the size or channel set changes.
+class CaptureBufferPool
+{
+public:
+    explicit CaptureBufferPool(size_t alignment = 64);
+    ~CaptureBufferPool();
+
+    // Sets the buffer length and enabled channels; drops pooled buffers and registrations if either changed.
+    // Returns true if the configuration changed.
+    bool configure(size_t samplesPerBuffer, uint32_t channelMask);
+
+    // preferred if it is free (e.g. registeredBuffer() of the segment about to be armed), otherwise
+    // a recycled buffer if one is free, otherwise a new one
+    std::shared_ptr<CaptureBuffer> acquire(const CaptureBuffer* preferred = nullptr);
+
+    // Returns true if buffer is not the one last registered on segment and channel (the caller must register it),
+    // and records it as registered
+    bool needsRegistration(int segment, int channel, const CaptureBuffer* buffer);
+    const CaptureBuffer* registeredBuffer(int segment, int channel) const;  // nullptr if none
+    void invalidateRegistrations();  // E.g. after the unit has been closed or re-opened
+
+    size_t bufferLength() const;
+    size_t allocatedCount() const;  // Buffers currently allocated by this pool, in use or free
+    size_t freeCount() const;  // Buffers waiting to be reused
+
+private:
+    struct State
+    {
+        std::mutex mutex;
+        size_t alignment = 64;
+        size_t length = 0;
+        uint32_t channelMask = 0;
+        uint64_t generation = 0;
+        size_t allocated = 0;
+        std::vector<CaptureBuffer*> freeBuffers;
+        std::vector<std::vector<const CaptureBuffer*>> registered;  // Per segment, per channel
+    };
+
+    static void release(const std::weak_ptr<State>& weakState, CaptureBuffer* buffer);
+    static void destroy(CaptureBuffer* buffer);
+
+    std::shared_ptr<State> state;  // Shared with the deleters of outstanding buffers
+};
+
+#endif // CAPTUREBUFFERPOOL_H
@@ -1,7 +1,7 @@
 // Author: Soroosh Sanatkhani
 // Columbia University
 // Created: 1 August, 2023
-// Last Modified : 21 June, 2024
+// Last Modified : 17 October, 2026
 
 #include "stdafx.h"  // Includes precompiled header files
 #include "Resources/qcustomplot.h"  // Includes the QCustomPlot library for plotting
@@ -9,6 +9,7 @@
 #include "FUSMainWindow.h"  // Includes the FUSMainWindow class
 #include "WaveformGenerator.h"
 #include "Gantry.h"
+#include "SampleConversion.h"
 
 using namespace std;
 
@@ -18,15 +19,25 @@ FUSMainWindow::FUSMainWindow(QWidget* parent)
     picoScope(new PicoScope(this)),
     waveformgenerator(new WaveformGenerator(this)),
     gantry(new Gantry(this)),
-    calibration(new Calibration(gantry, waveformgenerator, picoScope, arduino, this, this)),
+    calibration(new Calibration(gantry, waveformgenerator, picoScope, gantry->getArduino(), this, this)),
     completionTimer(new QTimer(this)),
     progressTimer(new QTimer(this))
 {
+    arduino = gantry->getArduino();
     ui.setupUi(this);
     this->setWindowIcon(QIcon(":/FUSMainWindow/Resources/logo.ico"));
-    ui.verticalLayout->addWidget(picoScope->getCustomPlot());
+    ui.verticalLayout->addWidget(picoScope->getCustomPlot(), 3);
+    QHBoxLayout* spectrumLayout = new QHBoxLayout();  // Spectrum, waterfall and scan field map side by side below the trace
+    spectrumLayout->addWidget(picoScope->getSpectrumPlot());
+    spectrumLayout->addWidget(picoScope->getWaterfallPlot());
+    spectrumLayout->addWidget(picoScope->getFieldMapView());
+    ui.verticalLayout->addLayout(spectrumLayout, 2);
 
     populateDIRComboBox(); // Now populate the combo box for the Gantry system direction
+    populateChannelComboBoxes(); // Channel B-D ranges offer the same list as channel A
+    picoScope->setPlotFrameRate(ui.PlotRate_spinBox->value());
+    picoScope->setSpectrumWindow(ui.FFTWindow_comboBox->currentIndex());
+    handleScanPlanChanged();
 
     // Connections
     connectSignalsAndSlots();
@@ -38,6 +49,8 @@ FUSMainWindow::FUSMainWindow(QWidget* parent)
     completionTimer = nullptr;
 
     ui.readButton->setEnabled(false);
+    ui.Stream_Button->setEnabled(false);
+    ui.RapidBlock_Button->setEnabled(false);
     ui.CloseButton->setEnabled(false);
 
     ui.Abort_Button->setEnabled(false);
@@ -49,6 +62,10 @@ FUSMainWindow::FUSMainWindow(QWidget* parent)
 // Defines the destructor of the FUSMainWindow class
 FUSMainWindow::~FUSMainWindow()
 {
+    if (benchmarkThread.joinable())
+    {
+        benchmarkThread.join();
+    }
     delete picoScope;
     delete waveformgenerator;
     delete calibration;
@@ -70,6 +87,11 @@ void FUSMainWindow::connectSignalsAndSlots()
     connect(ui.InitializeButton, &QPushButton::clicked, this, &FUSMainWindow::handleInitializeButton);
     connect(ui.readButton, &QPushButton::clicked, this, &FUSMainWindow::handleReadButton);
     connect(ui.CloseButton, &QPushButton::clicked, this, &FUSMainWindow::handleCloseButton);
+    connect(ui.Stream_Button, &QPushButton::clicked, this, &FUSMainWindow::handleStreamButton);
+    connect(ui.RapidBlock_Button, &QPushButton::clicked, this, &FUSMainWindow::handleRapidBlockButton);
+    connect(picoScope, &PicoScope::streamingFinished, this, &FUSMainWindow::handleStreamingFinished);
+    connect(picoScope, &PicoScope::acquisitionFinished, this, &FUSMainWindow::handleAcquisitionFinished);
+    connect(ui.actionBenchmarkConversion, &QAction::triggered, this, &FUSMainWindow::handleConversionBenchmark);
 
     // Connects the printSignal of PicoScope to the updateTextBox slot
     connect(this, &FUSMainWindow::printSignal, this, &FUSMainWindow::updateTextBox);
@@ -80,6 +102,8 @@ void FUSMainWindow::connectSignalsAndSlots()
     connect(ui.yaxisRange_lineEdit, &QLineEdit::textChanged, this, &FUSMainWindow::handleSpinBoxValueChanged);
     connect(ui.Range_comboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &FUSMainWindow::handleSpinBoxValueChanged);
     connect(ui.TriggerVoltage_lineEdit, &QLineEdit::textChanged, this, &FUSMainWindow::handleSpinBoxValueChanged);
+    connect(ui.FFTWindow_comboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int window) { picoScope->setSpectrumWindow(window); });
+    connect(ui.PlotRate_spinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int rate) { picoScope->setPlotFrameRate(rate); });
 
     // Connects the clicked signal of Waveform Generator buttons to their respective slots
     connect(ui.CheckDeviceButton, &QPushButton::clicked, this, &FUSMainWindow::handleCheckDeviceButton);
@@ -108,6 +132,16 @@ void FUSMainWindow::connectSignalsAndSlots()
 
     // Connects the UI parts related to Calibration
     connect(ui.Calibration_scan_Button, &QPushButton::clicked, this, &FUSMainWindow::handleCalibration_scan_ButtonClicked);
+    connect(ui.Calibration_focus_Button, &QPushButton::clicked, this, &FUSMainWindow::handleCalibration_focus_ButtonClicked);
+    connect(calibration, &Calibration::scanStateChanged, this, &FUSMainWindow::handleScanStateChanged);
+    QDoubleSpinBox* scanSpinBoxes[] = { ui.Scan_xStart_spinBox, ui.Scan_xStop_spinBox, ui.Scan_xStep_spinBox, ui.Scan_yStart_spinBox, ui.Scan_yStop_spinBox,
+        ui.Scan_yStep_spinBox, ui.Scan_zStart_spinBox, ui.Scan_zStop_spinBox, ui.Scan_zStep_spinBox };
+    for (QDoubleSpinBox* spinBox : scanSpinBoxes)
+    {
+        connect(spinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &FUSMainWindow::handleScanPlanChanged);
+    }
+    connect(ui.Scan_order_comboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &FUSMainWindow::handleScanPlanChanged);
+    connect(ui.Scan_serpentine_checkBox, &QCheckBox::toggled, this, &FUSMainWindow::handleScanPlanChanged);
 }
 
 // Defines the updateTextBox slot
@@ -127,17 +161,106 @@ void FUSMainWindow::emitPrintSignal(const QString& text)
 void FUSMainWindow::handleInitializeButton()
 {
     ui.readButton->setEnabled(true);
+    ui.Stream_Button->setEnabled(true);
+    ui.RapidBlock_Button->setEnabled(true);
     ui.CloseButton->setEnabled(true);
     PicoScope::PicoScope_Vars pico_vars = picoScope->initializePicoScope();  // Reads the parameters from the spin boxes
 }
 void FUSMainWindow::handleReadButton()
 {
-    picoScope->readBlockPicoScope();  // Reads the parameters from the spin boxes
+    if (picoScope->isAcquiring())
+    {
+        picoScope->stopAcquisition();  // handleAcquisitionFinished restores the buttons
+        return;
+    }
+    // One block, or blocks back to back until stopped; acquisition runs off the GUI thread
+    picoScope->startAcquisition(ui.Continuous_checkBox->isChecked() ? 0 : 1);
+    if (picoScope->isAcquiring())
+    {
+        ui.readButton->setText("Stop");
+        ui.Stream_Button->setEnabled(false);
+        ui.RapidBlock_Button->setEnabled(false);
+        ui.CloseButton->setEnabled(false);
+    }
+}
+void FUSMainWindow::handleAcquisitionFinished()
+{
+    ui.readButton->setText("Read");
+    ui.RapidBlock_Button->setText("Rapid block");
+    ui.readButton->setEnabled(true);
+    ui.Stream_Button->setEnabled(true);
+    ui.RapidBlock_Button->setEnabled(true);
+    ui.CloseButton->setEnabled(true);
+}
+void FUSMainWindow::handleRapidBlockButton()
+{
+    if (picoScope->isAcquiring())
+    {
+        picoScope->stopAcquisition();  // Keeps the segments completed so far; handleAcquisitionFinished restores the buttons
+        return;
+    }
+    // The rapid block capture runs off the GUI thread
+    picoScope->readRapidBlockPicoScope(getSegmentsValue());
+    if (picoScope->isAcquiring())
+    {
+        ui.RapidBlock_Button->setText("Stop");
+        ui.readButton->setEnabled(false);
+        ui.Stream_Button->setEnabled(false);
+        ui.CloseButton->setEnabled(false);
+    }
+}
+void FUSMainWindow::handleStreamButton()
+{
+    if (picoScope->isStreaming())
+    {
+        picoScope->stopStreaming();  // handleStreamingFinished restores the buttons
+        return;
+    }
+    // Stream for the sonication length set in the waveform generator panel
+    picoScope->streamPicoScope(getLengthValue());
+    if (picoScope->isStreaming())
+    {
+        ui.Stream_Button->setText("Stop stream");
+        ui.readButton->setEnabled(false);
+        ui.RapidBlock_Button->setEnabled(false);
+        ui.CloseButton->setEnabled(false);
+    }
+}
+void FUSMainWindow::handleStreamingFinished()
+{
+    ui.Stream_Button->setText("Stream");
+    ui.readButton->setEnabled(true);
+    ui.RapidBlock_Button->setEnabled(true);
+    ui.CloseButton->setEnabled(true);
+}
+void FUSMainWindow::handleConversionBenchmark()
+{
+    if (benchmarkRunning)
+    {
+        emitPrintSignal("Benchmark already running.");
+        return;
+    }
+    if (benchmarkThread.joinable())
+    {
+        benchmarkThread.join();
+    }
+    benchmarkRunning = true;
+    emitPrintSignal("Benchmarking sample conversion over 1, 10 and 100 M samples...");
+    benchmarkThread = std::thread([this]() {
+        for (const std::string& line : SampleConversion::benchmark())
+        {
+            emitPrintSignal(QString::fromStdString(line));
+        }
+        benchmarkRunning = false;
+    });
 }
 void FUSMainWindow::handleCloseButton()
 {
+    picoScope->stopStreaming();
     PicoScope::PicoScope_Vars pico_vars = picoScope->closePicoScope();  // Reads the parameters from the spin boxes
     ui.readButton->setEnabled(false);
+    ui.Stream_Button->setEnabled(false);
+    ui.RapidBlock_Button->setEnabled(false);
     ui.CloseButton->setEnabled(false);
 }
 // Defines the handleSpinBoxValueChanged slot
@@ -174,6 +297,41 @@ uint16_t FUSMainWindow::getTriggerVoltageValue()
 {
     return ui.TriggerVoltage_lineEdit->text().toInt();  // Returns the value of TriggerVoltage_lineEdit
 }
+bool FUSMainWindow::getSimulatedScopeValue()
+{
+    return ui.SimulatedScope_checkBox->isChecked();  // Returns the value of SimulatedScope_checkBox
+}
+bool FUSMainWindow::getCompressDataValue()
+{
+    return ui.CompressData_checkBox->isChecked();  // Returns the value of CompressData_checkBox
+}
+bool FUSMainWindow::getExportNpyValue()
+{
+    return ui.ExportNpy_checkBox->isChecked();  // Returns the value of ExportNpy_checkBox
+}
+bool FUSMainWindow::getExportMatValue()
+{
+    return ui.ExportMat_checkBox->isChecked();  // Returns the value of ExportMat_checkBox
+}
+bool FUSMainWindow::getChannelEnabledValue(int channel)
+{
+    QCheckBox* boxes[] = { ui.ChannelA_checkBox, ui.ChannelB_checkBox, ui.ChannelC_checkBox, ui.ChannelD_checkBox };
+    return channel >= 0 && channel < 4 && boxes[channel]->isChecked();  // Returns the value of Channel<X>_checkBox
+}
+bool FUSMainWindow::getChannelDCCoupledValue(int channel)
+{
+    QComboBox* boxes[] = { ui.ChannelA_Coupling_comboBox, ui.ChannelB_Coupling_comboBox, ui.ChannelC_Coupling_comboBox, ui.ChannelD_Coupling_comboBox };
+    return channel < 0 || channel >= 4 || boxes[channel]->currentIndex() == 0;  // Index 0 is DC, 1 is AC
+}
+uint16_t FUSMainWindow::getChannelRangeValue(int channel)
+{
+    QComboBox* boxes[] = { ui.Range_comboBox, ui.ChannelB_Range_comboBox, ui.ChannelC_Range_comboBox, ui.ChannelD_Range_comboBox };
+    return (channel >= 0 && channel < 4 ? boxes[channel] : ui.Range_comboBox)->currentIndex();  // Channel A keeps Range_comboBox
+}
+uint16_t FUSMainWindow::getSegmentsValue()
+{
+    return ui.Segments_spinBox->value();  // Returns the value of Segments_spinBox
+}
 
 ///////////////////////////////////
 /////// Waveform Generator ///////
@@ -263,6 +421,7 @@ void FUSMainWindow::handleGenerateWaveformButton()
 
     // Start the elapsed timer
     elapsedTimer.start();
+    picoScope->clearWaterfall();  // The waterfall shows this run only
 
     progressBar->setRange(0, waveformgenerator->WaveformGenerator_Vars.Length);
     progressBar->setValue(0);
@@ -382,6 +541,21 @@ void FUSMainWindow::handleGantryToggleButtonClicked()
         gantry->on();
     }
 }
+// Fills the channel B-D range combo boxes with the ranges of Range_comboBox
+void FUSMainWindow::populateChannelComboBoxes()
+{
+    QComboBox* boxes[] = { ui.ChannelB_Range_comboBox, ui.ChannelC_Range_comboBox, ui.ChannelD_Range_comboBox };
+    for (QComboBox* box : boxes)
+    {
+        box->clear();
+        for (int i = 0; i < ui.Range_comboBox->count(); i++)
+        {
+            box->addItem(ui.Range_comboBox->itemText(i));
+        }
+        box->setCurrentIndex(ui.Range_comboBox->currentIndex());
+    }
+}
+
 void FUSMainWindow::populateDIRComboBox() {
     QStringList options = { "Right", "Left", "Up", "Down", "Forward", "Backward"};
     ui.Gantry_DIR_comboBox->addItems(options);
@@ -444,8 +618,78 @@ void FUSMainWindow::handleGantry_movetoposition_ButtonClicked()
 /////// Calibration Functions ///////
 void FUSMainWindow::handleCalibration_scan_ButtonClicked()
 {
+    if (calibration->isScanning())
+    {
+        calibration->stopScan();
+        return;
+    }
 	calibration->scan3DVolume();
 }
+void FUSMainWindow::handleCalibration_focus_ButtonClicked()
+{
+    if (calibration->isScanning())
+    {
+        calibration->stopScan();
+        return;
+    }
+    calibration->findFocus();
+}
+void FUSMainWindow::handleScanStateChanged(bool running)
+{
+    ui.Calibration_scan_Button->setText(running ? "Stop" : "Scan");
+    ui.Calibration_focus_Button->setText(running ? "Stop" : "Focus");
+}
+int FUSMainWindow::getFocusMetricValue()
+{
+    return ui.Focus_metric_comboBox->currentIndex();  // Returns the index of Focus_metric_comboBox
+}
+double FUSMainWindow::getFocusResolutionValue()
+{
+    return ui.Focus_resolution_spinBox->value();  // Returns the value of Focus_resolution_spinBox
+}
+double FUSMainWindow::getHydrophoneSensitivityValue()
+{
+    return ui.Hydrophone_sensitivity_spinBox->value();  // Returns the value of Hydrophone_sensitivity_spinBox
+}
+ScanPlan FUSMainWindow::getScanPlan()
+{
+    ScanPlan plan;
+    QDoubleSpinBox* spinBoxes[3][3] = {
+        { ui.Scan_xStart_spinBox, ui.Scan_xStop_spinBox, ui.Scan_xStep_spinBox },
+        { ui.Scan_yStart_spinBox, ui.Scan_yStop_spinBox, ui.Scan_yStep_spinBox },
+        { ui.Scan_zStart_spinBox, ui.Scan_zStop_spinBox, ui.Scan_zStep_spinBox } };
+    for (int axis = 0; axis < 3; axis++)
+    {
+        plan.axes[axis] = { spinBoxes[axis][0]->value(), spinBoxes[axis][1]->value(), spinBoxes[axis][2]->value() };
+    }
+    const QString order = ui.Scan_order_comboBox->currentText();  // e.g. "XYZ", slowest axis first
+    for (int level = 0; level < 3 && level < order.size(); level++)
+    {
+        plan.order[level] = order[level].unicode() - 'X';
+    }
+    plan.serpentine = ui.Scan_serpentine_checkBox->isChecked();
+    return plan;
+}
+void FUSMainWindow::handleScanPlanChanged()
+{
+    ScanPlan plan = getScanPlan();
+    std::string error;
+    if (!plan.valid(error))
+    {
+        ui.Scan_plan_label->setText(QString::fromStdString(error));
+        return;
+    }
+    if (plan.points() > 1000000)  // Not walked on every edit
+    {
+        ui.Scan_plan_label->setText(QString("%1 x %2 x %3 = %4 points").arg(plan.count(0)).arg(plan.count(1)).arg(plan.count(2)).arg(plan.points()));
+        return;
+    }
+    ScanPlan raster = plan;
+    raster.serpentine = false;
+    ui.Scan_plan_label->setText(QString("%1 x %2 x %3 = %4 points, travel %5 mm (raster %6 mm)")
+        .arg(plan.count(0)).arg(plan.count(1)).arg(plan.count(2)).arg(plan.points())
+        .arg(plan.travelMm(), 0, 'f', 1).arg(raster.travelMm(), 0, 'f', 1));
+}
 void FUSMainWindow::Calibration_Pulse()
 {
     waveformgenerator->readParameters(
@@ -458,6 +702,7 @@ void FUSMainWindow::Calibration_Pulse()
 
     // Start the elapsed timer
     elapsedTimer.start();
+    picoScope->clearWaterfall();  // The waterfall shows this run only
 
     progressBar->setRange(0, waveformgenerator->WaveformGenerator_Vars.Length);
     progressBar->setValue(0);
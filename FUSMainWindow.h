@@ -1,7 +1,7 @@
 // Author: Soroosh Sanatkhani
 // Columbia University
 // Created: 1 August, 2023
-// Last Modified : 21 June, 2024
+// Last Modified : 17 October, 2026
 
 #pragma once  // Ensures the header file is included only once in a single compilation
 
@@ -12,10 +12,13 @@
 #include "WaveformGenerator.h"
 #include "Gantry.h"
 #include "Calibration.h"
+#include "ScanPlan.h"  // Scan volume and path built from the Scan_* widgets
 #include <QProgressBar>
 #include <QStateMachine>
 #include <QState>
 #include <QSignalTransition>
+#include <thread>  // For the benchmark thread
+#include <atomic>
 
 // Declares the FUSMainWindow class as a subclass of QMainWindow
 class FUSMainWindow : public QMainWindow
@@ -28,6 +31,7 @@ public:
     Ui::FUSMainWindowClass ui;  // Instance of the UI class
 
     void populateDIRComboBox(); // Method to populate the combo box
+    void populateChannelComboBoxes(); // Method to populate the channel B-D range combo boxes
 
     void emitPrintSignal(const QString& text);  // Function to emit the printSignal
 
@@ -36,6 +40,14 @@ public:
     int getYaxisRangeValue();  // Getter for the value of yaxisRange_lineEdit
     uint16_t getRangeValue();  // Getter for the value of Range_comboBox
     uint16_t getTriggerVoltageValue();  // Getter for the value of TriggerVoltage_lineEdit
+    uint16_t getSegmentsValue();  // Getter for the value of Segments_spinBox
+    bool getSimulatedScopeValue();  // Getter for the value of SimulatedScope_checkBox
+    bool getCompressDataValue();  // Getter for the value of CompressData_checkBox
+    bool getExportNpyValue();  // Getter for the value of ExportNpy_checkBox
+    bool getExportMatValue();  // Getter for the value of ExportMat_checkBox
+    bool getChannelEnabledValue(int channel);  // Getter for Channel<X>_checkBox, channel 0-3 for A-D
+    bool getChannelDCCoupledValue(int channel);  // Getter for Channel<X>_Coupling_comboBox
+    uint16_t getChannelRangeValue(int channel);  // Getter for the channel range combo box (Range_comboBox for A)
 
     /////// Waveform Generator
     unsigned int getFrequencyValue();
@@ -47,6 +59,10 @@ public:
 
     /////// Calibration
     void Calibration_Pulse();
+    ScanPlan getScanPlan();  // Scan volume, steps and path order from the Scan_* widgets
+    int getFocusMetricValue();  // Getter for Focus_metric_comboBox: 0 peak negative, 1 RMS
+    double getFocusResolutionValue();  // Getter for the value of Focus_resolution_spinBox (mm)
+    double getHydrophoneSensitivityValue();  // Getter for the value of Hydrophone_sensitivity_spinBox (mV/MPa)
 
 signals:
     void printSignal(const QString& text);  // Signal to print text
@@ -59,6 +75,11 @@ private slots:
     void handleInitializeButton();
     void handleCloseButton();
     void handleReadButton();
+    void handleAcquisitionFinished();
+    void handleStreamButton();
+    void handleRapidBlockButton();
+    void handleStreamingFinished();
+    void handleConversionBenchmark();  // Runs the SampleConversion benchmark off the GUI thread
 
     ///// Waveform Generator Functions //////
     void handleSpinBox_Waveform_ValueChanged();
@@ -88,6 +109,9 @@ private slots:
 
     // Calibration Functions
     void handleCalibration_scan_ButtonClicked();
+    void handleCalibration_focus_ButtonClicked();
+    void handleScanStateChanged(bool running);  // Scan and Focus buttons stop a running scan
+    void handleScanPlanChanged();  // Shows the points and travel of the scan plan
 
 private:
     PicoScope* picoScope;  // Pointer to a PicoScope object
@@ -101,4 +125,7 @@ private:
     QTimer* completionTimer;
 
     QGroupBox* waveformGroupBox;
+
+    std::thread benchmarkThread;
+    std::atomic<bool> benchmarkRunning{ false };
 };
\ No newline at end of file
@@ -61,6 +61,12 @@ void loop()
   if (commandCount > 0) {
     String command = dequeueCommand();
     processCommand(command);
+    while (Serial.available() > 0) { // Commands sent while this one ran
+      enqueueCommand(Serial.readStringUntil('\n'));
+    }
+    if (commandCount == 0) {
+      Serial.println("G"); // Green light: every queued move is done (the host waits for it as gantryReady)
+    }
   }
 }
 
@@ -0,0 +1,207 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "FieldMap.h"
+#include "PulseMetrics.h"
+#include "ScanVolumeFile.h"
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+void FieldMap::reset(const ScanGrid& grid, const Settings& settings)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    mapGrid = grid;
+    mapSettings = settings;
+    values.assign(grid.points() * MetricCount, std::numeric_limits<float>::quiet_NaN());
+    measured = 0;
+}
+
+bool FieldMap::add(int32_t x, int32_t y, int32_t z, const PicoCapture& capture)
+{
+    ScanGrid grid;
+    Settings settings;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        grid = mapGrid;
+        settings = mapSettings;
+    }
+    size_t cell;
+    if (!grid.cellOf(x, y, z, cell) || !capture.hasChannel(0) || capture.size() == 0)
+    {
+        return false;
+    }
+
+    // Everything from the raw counts: one pass for the extremes and sums, block sums for the energy quantiles
+    const int16_t* raw = capture.samples(0);
+    const size_t count = capture.size();
+    const PulseMetrics::Summary summary = PulseMetrics::summarize(raw, count);
+    const double mean = summary.mean();
+    const double mpaPerCount = capture.mvPerCount(0) / settings.sensitivityMvPerMPa;
+    const double paPerCount = mpaPerCount * 1e6;
+    const double dtSeconds = capture.dt() * 1e-9;
+
+    float metrics[MetricCount];
+    metrics[PeakPositive] = (float)((summary.maximum - mean) * mpaPerCount);
+    metrics[PeakNegative] = (float)((mean - summary.minimum) * mpaPerCount);
+
+    const double energy = summary.rms() * summary.rms() * count;  // counts^2
+    const double pii = energy * paPerCount * paPerCount * dtSeconds / settings.impedanceRayl;
+    metrics[Pii] = (float)pii;
+
+    const double fractions[2] = { 0.1, 0.9 };
+    size_t quantiles[2];
+    PulseMetrics::energyQuantiles(raw, count, mean, fractions, quantiles, 2);
+    const double duration = 1.25 * (std::max)((size_t)1, quantiles[1] - quantiles[0]) * dtSeconds;
+    metrics[Isppa] = (float)(pii / duration / 1e4);  // W/m^2 to W/cm^2
+
+    const double half = (std::max)(summary.maximum - mean, mean - summary.minimum) / 2;
+    const int16_t low = (int16_t)(std::max)(-32768.0, std::floor(mean - half));
+    const int16_t high = (int16_t)(std::min)(32767.0, std::ceil(mean + half));
+    const size_t arrival = half > 0 ? PulseMetrics::firstOutside(raw, count, low, high) : count;
+    metrics[Arrival] = arrival < count ? (float)(capture.timeAt(arrival) / 1000.0) : std::numeric_limits<float>::quiet_NaN();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (mapGrid.points() != grid.points() || values.empty())
+    {
+        return false;  // Reset meanwhile
+    }
+    float* stored = &values[cell * MetricCount];
+    if (std::isnan(stored[PeakPositive]))
+    {
+        measured++;
+    }
+    std::copy(metrics, metrics + MetricCount, stored);
+    return true;
+}
+
+ScanGrid FieldMap::getGrid() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return mapGrid;
+}
+
+bool FieldMap::value(Metric metric, uint32_t ix, uint32_t iy, uint32_t iz, float& value) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (values.empty() || ix >= mapGrid.count[0] || iy >= mapGrid.count[1] || iz >= mapGrid.count[2])
+    {
+        return false;
+    }
+    value = values[(((size_t)ix * mapGrid.count[1] + iy) * mapGrid.count[2] + iz) * MetricCount + metric];
+    return !std::isnan(value);
+}
+
+bool FieldMap::maximum(Metric metric, uint32_t index[3], float& value) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    bool found = false;
+    for (size_t cell = 0; cell < mapGrid.points() && !values.empty(); cell++)
+    {
+        const float v = values[cell * MetricCount + metric];
+        if (!std::isnan(v) && (!found || v > value))
+        {
+            value = v;
+            index[0] = (uint32_t)(cell / ((size_t)mapGrid.count[1] * mapGrid.count[2]));
+            index[1] = (uint32_t)(cell / mapGrid.count[2] % mapGrid.count[1]);
+            index[2] = (uint32_t)(cell % mapGrid.count[2]);
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool FieldMap::slice(Metric metric, int normalAxis, uint32_t index, std::vector<float>& slice) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (values.empty() || normalAxis < 0 || normalAxis > 2 || index >= mapGrid.count[normalAxis])
+    {
+        return false;
+    }
+    const int columnAxis = normalAxis == 0 ? 1 : 0;
+    const int rowAxis = normalAxis == 2 ? 1 : 2;
+    const uint32_t columns = mapGrid.count[columnAxis];
+    const uint32_t rows = mapGrid.count[rowAxis];
+    slice.resize((size_t)columns * rows);
+    uint32_t cellIndex[3];
+    cellIndex[normalAxis] = index;
+    for (uint32_t row = 0; row < rows; row++)
+    {
+        cellIndex[rowAxis] = row;
+        for (uint32_t column = 0; column < columns; column++)
+        {
+            cellIndex[columnAxis] = column;
+            const size_t cell = ((size_t)cellIndex[0] * mapGrid.count[1] + cellIndex[1]) * mapGrid.count[2] + cellIndex[2];
+            slice[(size_t)row * columns + column] = values[cell * MetricCount + metric];
+        }
+    }
+    return true;
+}
+
+size_t FieldMap::pointsMeasured() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return measured;
+}
+
+bool FieldMap::save(const std::filesystem::path& base, std::filesystem::path& written, std::string& error) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (values.empty())
+    {
+        error = "Field map is empty";
+        return false;
+    }
+    written = base;
+    written += "_fieldmap.npy";
+    const std::string header = ScanVolumeFile::npyHeader("<f4", { mapGrid.count[0], mapGrid.count[1], mapGrid.count[2], (uint64_t)MetricCount });
+    std::ofstream out(written, std::ios::binary | std::ios::trunc);
+    out.write(header.data(), (std::streamsize)header.size());
+    out.write((const char*)values.data(), (std::streamsize)(values.size() * sizeof(float)));
+    if (!out)
+    {
+        error = "Unable to write " + written.string();
+        return false;
+    }
+    return true;
+}
+
+const char* FieldMap::metricName(Metric metric)
+{
+    switch (metric)
+    {
+    case PeakPositive:
+        return "Peak positive pressure";
+    case PeakNegative:
+        return "Peak negative pressure";
+    case Pii:
+        return "Pulse intensity integral";
+    case Isppa:
+        return "I_SPPA";
+    case Arrival:
+        return "Arrival time";
+    default:
+        return "";
+    }
+}
+
+const char* FieldMap::metricUnit(Metric metric)
+{
+    switch (metric)
+    {
+    case PeakPositive:
+    case PeakNegative:
+        return "MPa";
+    case Pii:
+        return "J/m^2";
+    case Isppa:
+        return "W/cm^2";
+    case Arrival:
+        return "us";
+    default:
+        return "";
+    }
+}
@@ -0,0 +1,73 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef FIELDMAP_H  // Include guard to prevent multiple inclusions
+#define FIELDMAP_H
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "PicoCapture.h"
+#include "ScanGrid.h"
+
+// Acoustic field of a gridded scan, built point by point as the captures arrive: per grid cell the metrics of
+// the hydrophone trace on channel A, with the trace mean taken as zero pressure.
+//
+//   PeakPositive   peak positive pressure, MPa
+//   PeakNegative   peak negative (rarefactional) pressure, MPa, as a positive number
+//   Pii            pulse intensity integral, integral of p^2 / (rho c) over the trace, J/m^2
+//   Isppa          spatial-peak pulse-average intensity at the point, PII over the pulse duration, W/cm^2
+//                  (the duration is 1.25 x the time between 10 % and 90 % of the cumulative PII, IEC 62127-1)
+//   Arrival        time of the first sample beyond half the peak pressure, us from the trigger
+//
+// Cells not measured hold NaN. add() runs on a worker thread while the GUI queries the map; both lock.
+class FieldMap
+{
+public:
+    enum Metric
+    {
+        PeakPositive,
+        PeakNegative,
+        Pii,
+        Isppa,
+        Arrival,
+        MetricCount
+    };
+
+    struct Settings
+    {
+        double sensitivityMvPerMPa = 100;  // Hydrophone (plus amplifier)
+        double impedanceRayl = 1.482e6;  // rho c of water at 20 C
+    };
+
+    void reset(const ScanGrid& grid, const Settings& settings);  // Every cell not measured
+    bool add(int32_t x, int32_t y, int32_t z, const PicoCapture& capture);  // False if off the grid or no channel A
+
+    ScanGrid getGrid() const;
+    bool value(Metric metric, uint32_t ix, uint32_t iy, uint32_t iz, float& value) const;  // False if not measured
+    bool maximum(Metric metric, uint32_t index[3], float& value) const;  // Largest measured value and its cell
+
+    // The plane of cells at index along normalAxis, under one lock: the other two axes in ascending order as
+    // columns and rows, row by row (e.g. normal z: values[iy * nx + ix]); false if index is off the grid
+    bool slice(Metric metric, int normalAxis, uint32_t index, std::vector<float>& values) const;
+    size_t pointsMeasured() const;
+
+    // <base>_fieldmap.npy: float32 of shape (nx, ny, nz, MetricCount) in the order of Metric, NaN where not measured
+    bool save(const std::filesystem::path& base, std::filesystem::path& written, std::string& error) const;
+
+    static const char* metricName(Metric metric);
+    static const char* metricUnit(Metric metric);
+
+private:
+    mutable std::mutex mutex;
+    ScanGrid mapGrid;
+    Settings mapSettings;
+    std::vector<float> values;  // Cell-major: ((ix * ny + iy) * nz + iz) * MetricCount + metric
+    size_t measured = 0;
+};
+
+#endif // FIELDMAP_H
@@ -0,0 +1,217 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "FieldMapView.h"
+#include "ScanPlan.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <cmath>
+#include <limits>
+
+FieldMapView::FieldMapView(const FieldMap& fieldMap, QWidget* parent) : QWidget(parent), fieldMap(fieldMap)
+{
+    planeComboBox = new QComboBox();
+    planeComboBox->addItems({ "XY", "XZ", "YZ" });
+    planeComboBox->setToolTip("Field map: plane shown");
+    sliceSpinBox = new QSpinBox();
+    sliceSpinBox->setToolTip("Field map: slice index along the axis across the plane");
+    sliceLabel = new QLabel();
+    metricComboBox = new QComboBox();
+    for (int metric = 0; metric < FieldMap::MetricCount; metric++)
+    {
+        metricComboBox->addItem(QString("%1 (%2)").arg(FieldMap::metricName((FieldMap::Metric)metric)).arg(FieldMap::metricUnit((FieldMap::Metric)metric)));
+    }
+    metricComboBox->setCurrentIndex(FieldMap::PeakNegative);
+    followCheckBox = new QCheckBox("Follow");
+    followCheckBox->setToolTip("Field map: show the slice the scan is in");
+    followCheckBox->setChecked(true);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    controls->addWidget(planeComboBox);
+    controls->addWidget(sliceSpinBox);
+    controls->addWidget(sliceLabel);
+    controls->addWidget(metricComboBox, 1);
+    controls->addWidget(followCheckBox);
+
+    // Cells not measured yet are NaN and stay transparent
+    plot = new QCustomPlot();
+    colorMap = new QCPColorMap(plot->xAxis, plot->yAxis);
+    colorMap->setInterpolate(false);
+    colorScale = new QCPColorScale(plot);
+    plot->plotLayout()->addElement(0, 1, colorScale);
+    colorMap->setColorScale(colorScale);
+    QCPColorGradient gradient(QCPColorGradient::gpJet);
+    gradient.setNanHandling(QCPColorGradient::nhTransparent);
+    colorScale->setGradient(gradient);  // The map follows its colour scale
+    replotScheduler = new ReplotScheduler(plot, this);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(controls);
+    layout->addWidget(plot, 1);
+
+    connect(planeComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &FieldMapView::showSlice);
+    connect(sliceSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &FieldMapView::showSlice);
+    connect(metricComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &FieldMapView::showSlice);
+    reset();
+}
+
+void FieldMapView::reset()
+{
+    grid = fieldMap.getGrid();
+    {
+        QSignalBlocker blocker(sliceSpinBox);
+        sliceSpinBox->setValue(0);
+    }
+    showSlice();
+}
+
+// A point in the slice shown sets its one cell; with Follow a point in another slice switches to that slice
+void FieldMapView::pointAdded(int x, int y, int z)
+{
+    uint32_t index[3];
+    if (!grid.indexOf(0, x, index[0]) || !grid.indexOf(1, y, index[1]) || !grid.indexOf(2, z, index[2]))
+    {
+        return;  // Not of this grid, e.g. reset() is still queued
+    }
+    const int normal = normalAxis();
+    if ((int)index[normal] != sliceSpinBox->value())
+    {
+        if (followCheckBox->isChecked())
+        {
+            sliceSpinBox->setValue((int)index[normal]);  // showSlice copies the new slice, this point included
+        }
+        return;
+    }
+    float value;
+    if (fieldMap.value((FieldMap::Metric)metricComboBox->currentIndex(), index[0], index[1], index[2], value))
+    {
+        setCell(toCell(columnAxis(), index[columnAxis()]), toCell(rowAxis(), index[rowAxis()]), value);
+        replotScheduler->requestFrame();
+    }
+}
+
+void FieldMapView::showSlice()
+{
+    const int normal = normalAxis();
+    const int columnAxis = this->columnAxis();
+    const int rowAxis = this->rowAxis();
+    {
+        QSignalBlocker blocker(sliceSpinBox);
+        sliceSpinBox->setMaximum((int)(std::max)(1u, grid.count[normal]) - 1);
+    }
+    updateSliceLabel();
+
+    // An axis with one position gets two identical cells: a colour map needs two to span a range
+    QCPColorMapData* data = colorMap->data();
+    const int columns = (int)(std::max)(2u, grid.count[columnAxis]);
+    const int rows = (int)(std::max)(2u, grid.count[rowAxis]);
+    if (data->keySize() != columns || data->valueSize() != rows)
+    {
+        data->setSize(columns, rows);
+    }
+    QCPRange ranges[2];
+    const int axes[2] = { columnAxis, rowAxis };
+    for (int k = 0; k < 2; k++)
+    {
+        const int axis = axes[k];
+        const double first = grid.count[axis] ? grid.position(axis, 0) / (double)ScanPlan::micrometresPerMm : 0;
+        const double last = grid.count[axis] ? grid.position(axis, grid.count[axis] - 1) / (double)ScanPlan::micrometresPerMm : 0;
+        ranges[k] = first == last ? QCPRange(first - 0.05, first + 0.05) : QCPRange((std::min)(first, last), (std::max)(first, last));
+    }
+    data->setRange(ranges[0], ranges[1]);
+    data->fill(std::numeric_limits<double>::quiet_NaN());
+
+    hasRange = false;
+    const FieldMap::Metric metric = (FieldMap::Metric)metricComboBox->currentIndex();
+    if (fieldMap.slice(metric, normal, (uint32_t)sliceSpinBox->value(), sliceValues))
+    {
+        for (uint32_t row = 0; row < grid.count[rowAxis]; row++)
+        {
+            for (uint32_t column = 0; column < grid.count[columnAxis]; column++)
+            {
+                const float value = sliceValues[(size_t)row * grid.count[columnAxis] + column];
+                if (!std::isnan(value))
+                {
+                    setCell(toCell(columnAxis, column), toCell(rowAxis, row), value);
+                }
+            }
+        }
+    }
+
+    plot->xAxis->setLabel(QString("%1 (mm)").arg(ScanPlan::axisName(columnAxis)));
+    plot->yAxis->setLabel(QString("%1 (mm)").arg(ScanPlan::axisName(rowAxis)));
+    colorScale->axis()->setLabel(metricComboBox->currentText());
+    plot->rescaleAxes();
+    replotScheduler->requestFrame();
+}
+
+int FieldMapView::normalAxis() const
+{
+    switch (planeComboBox->currentIndex())
+    {
+    case XZ:
+        return 1;
+    case YZ:
+        return 0;
+    default:
+        return 2;
+    }
+}
+
+int FieldMapView::toCell(int axis, uint32_t index) const
+{
+    return grid.step[axis] < 0 ? (int)(grid.count[axis] - 1 - index) : (int)index;
+}
+
+// Sets the cell (and its twin on an axis with one position) and widens the colour range to the value
+void FieldMapView::setCell(int column, int row, float value)
+{
+    QCPColorMapData* data = colorMap->data();
+    data->setCell(column, row, value);
+    const bool singleColumn = grid.count[columnAxis()] == 1;
+    const bool singleRow = grid.count[rowAxis()] == 1;
+    if (singleColumn)
+    {
+        data->setCell(1, row, value);
+    }
+    if (singleRow)
+    {
+        data->setCell(column, 1, value);
+    }
+    if (singleColumn && singleRow)
+    {
+        data->setCell(1, 1, value);
+    }
+
+    if (!hasRange)
+    {
+        valueRange = QCPRange(value, value);
+        hasRange = true;
+    }
+    else if (value < valueRange.lower || value > valueRange.upper)
+    {
+        valueRange.expand(value);
+    }
+    else
+    {
+        return;
+    }
+    // A single value has no range yet; centre it
+    colorMap->setDataRange(valueRange.size() > 0 ? valueRange : QCPRange(value - 0.5, value + 0.5));
+}
+
+void FieldMapView::updateSliceLabel()
+{
+    const int normal = normalAxis();
+    if (grid.count[normal] == 0)
+    {
+        sliceLabel->clear();
+        return;
+    }
+    sliceLabel->setText(QString("%1 = %2 mm").arg(ScanPlan::axisName(normal))
+        .arg(grid.position(normal, (uint32_t)sliceSpinBox->value()) / (double)ScanPlan::micrometresPerMm, 0, 'f', 1));
+}
@@ -0,0 +1,70 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef FIELDMAPVIEW_H  // Include guard to prevent multiple inclusions
+#define FIELDMAPVIEW_H
+
+#include <QWidget>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QLabel>
+#include <vector>
+#include "FieldMap.h"
+#include "ReplotScheduler.h"
+#include "Resources/qcustomplot.h"
+
+// Live heat map of one slice of the field map (XY, XZ or YZ plane, any metric) while a gridded scan runs.
+// Every point the field map adds sets just its own cell, if it lies in the slice shown, and asks for a frame;
+// the slice is only copied from the field map as a whole when the plane, slice or metric changes. With
+// Follow checked the slice moves with the scan, otherwise it stays where the user put it.
+class FieldMapView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FieldMapView(const FieldMap& fieldMap, QWidget* parent = nullptr);
+
+    void setMaxRate(double framesPerSecond) { replotScheduler->setMaxRate(framesPerSecond); }
+
+public slots:
+    void reset();  // The field map has a new grid: shows its first slice, empty
+    void pointAdded(int x, int y, int z);  // The field map has the point (um)
+
+private slots:
+    void showSlice();  // Copies the whole slice from the field map
+
+private:
+    enum Plane
+    {
+        XY,
+        XZ,
+        YZ
+    };
+
+    int normalAxis() const;  // Axis across the plane shown
+    int columnAxis() const { return normalAxis() == 0 ? 1 : 0; }  // Map key, as in FieldMap::slice
+    int rowAxis() const { return normalAxis() == 2 ? 1 : 2; }  // Map value
+    int toCell(int axis, uint32_t index) const;  // Map cells run in ascending position even for a negative step
+    void setCell(int column, int row, float value);
+    void updateSliceLabel();
+
+    const FieldMap& fieldMap;
+    ScanGrid grid;
+    QComboBox* planeComboBox;
+    QSpinBox* sliceSpinBox;
+    QLabel* sliceLabel;  // Position of the slice in mm
+    QComboBox* metricComboBox;
+    QCheckBox* followCheckBox;
+    QCustomPlot* plot;
+    QCPColorMap* colorMap;  // Owned by plot
+    QCPColorScale* colorScale;  // Owned by plot
+    ReplotScheduler* replotScheduler;
+    std::vector<float> sliceValues;  // Reused by showSlice
+    bool hasRange = false;  // The colour range spans the values shown so far
+    QCPRange valueRange;
+};
+
+#endif // FIELDMAPVIEW_H
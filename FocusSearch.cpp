@@ -0,0 +1,273 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "FocusSearch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+    const int32_t latticeUm = 100;  // The gantry resolves 0.1 mm
+}
+
+bool FocusSearch::start(const ScanPlan& coarse, double targetResolutionMm, std::string& error)
+{
+    currentPhase = Phase::Idle;
+    values.clear();
+    pending.clear();
+    edges.clear();
+    if (!coarse.valid(error))
+    {
+        return false;
+    }
+    target = (std::max)(latticeUm, toLattice((int32_t)std::lround(targetResolutionMm * ScanPlan::micrometresPerMm)));
+
+    const ScanGrid grid = coarse.grid();
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const int32_t first = grid.position(axis, 0);
+        const int32_t last = grid.position(axis, grid.count[axis] - 1);
+        lowerBound[axis] = (std::min)(first, last);
+        upperBound[axis] = (std::max)(first, last);
+        coarseStep[axis] = grid.count[axis] > 1 ? std::abs(grid.step[axis]) : 0;
+    }
+    for (const ScanPoint& point : coarse.path())
+    {
+        pending.push_back({ point.position[0], point.position[1], point.position[2] });
+    }
+    bestValue = 0;
+    focusValue = 0;
+    currentPhase = Phase::Coarse;
+    return true;
+}
+
+bool FocusSearch::next(int32_t position[3])
+{
+    for (;;)
+    {
+        while (!pending.empty())
+        {
+            const Point point = pending.front();
+            pending.pop_front();
+            if (!values.count(point))
+            {
+                std::copy(point.begin(), point.end(), position);
+                return true;
+            }
+        }
+        if (!advance())
+        {
+            return false;
+        }
+    }
+}
+
+void FocusSearch::report(const int32_t position[3], double value)
+{
+    const Point point = { position[0], position[1], position[2] };
+    values[point] = value;
+    if (values.size() == 1 || value > bestValue)
+    {
+        bestPoint = point;
+        bestValue = value;
+    }
+}
+
+bool FocusSearch::advance()
+{
+    switch (currentPhase)
+    {
+    case Phase::Coarse:
+        if (values.empty())
+        {
+            currentPhase = Phase::Done;
+            return false;
+        }
+        std::copy(coarseStep, coarseStep + 3, refineStep);
+        currentPhase = Phase::Refine;
+        [[fallthrough]];
+    case Phase::Refine:
+        if (startRefineLevel())
+        {
+            return true;
+        }
+        focus = bestPoint;
+        focusValue = bestValue;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (coarseStep[axis] > 0)
+            {
+                edges.push_back({ axis, -1, focus[axis], 0, false, false, false, 0 });
+                edges.push_back({ axis, 1, focus[axis], 0, false, false, false, 0 });
+            }
+        }
+        currentPhase = Phase::Extent;
+        [[fallthrough]];
+    case Phase::Extent:
+        if (advanceEdges())
+        {
+            return true;
+        }
+        currentPhase = Phase::Done;
+        return false;
+    default:
+        return false;
+    }
+}
+
+// Queues a box of +/- the current step around the best point, sampled at half the step, in serpentine order
+bool FocusSearch::startRefineLevel()
+{
+    bool finer = false;
+    ScanPlan box;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const int32_t previous = refineStep[axis];
+        const int32_t centre = bestPoint[axis];
+        ScanPlan::Axis& a = box.axes[axis];
+        if (previous == 0)
+        {
+            a.start = a.stop = centre / (double)ScanPlan::micrometresPerMm;
+            a.step = latticeUm / (double)ScanPlan::micrometresPerMm;
+            continue;
+        }
+        const int32_t step = previous > target ? (std::max)(target, toLattice(previous / 2)) : previous;
+        finer = finer || step < previous;
+        refineStep[axis] = step;
+        const int32_t below = ((std::min)(previous, centre - lowerBound[axis]) / step) * step;
+        const int32_t above = ((std::min)(previous, upperBound[axis] - centre) / step) * step;
+        a.start = (centre - below) / (double)ScanPlan::micrometresPerMm;
+        a.stop = (centre + above) / (double)ScanPlan::micrometresPerMm;
+        a.step = step / (double)ScanPlan::micrometresPerMm;
+    }
+    if (!finer)
+    {
+        return false;
+    }
+    for (const ScanPoint& point : box.path())
+    {
+        pending.push_back({ point.position[0], point.position[1], point.position[2] });
+    }
+    return true;
+}
+
+// Advances every edge walk as far as the measured points allow; queues the first point it is missing
+bool FocusSearch::advanceEdges()
+{
+    const double half = focusValue / 2;  // -6 dB of an amplitude
+    for (Edge& edge : edges)
+    {
+        const int axis = edge.axis;
+        while (!edge.done)
+        {
+            Point point = focus;
+            if (!edge.bracketed)
+            {
+                const int32_t bound = edge.direction > 0 ? upperBound[axis] : lowerBound[axis];
+                if (edge.inside == bound)
+                {
+                    edge.done = true;  // Still above half the peak at the edge of the volume
+                    break;
+                }
+                const int32_t candidate = edge.inside + edge.direction * coarseStep[axis];
+                point[axis] = edge.direction > 0 ? (std::min)(candidate, bound) : (std::max)(candidate, bound);
+            }
+            else
+            {
+                const int32_t gap = std::abs(edge.outside - edge.inside);
+                if (gap <= target)
+                {
+                    Point inside = focus;
+                    inside[axis] = edge.inside;
+                    Point outside = focus;
+                    outside[axis] = edge.outside;
+                    const double insideValue = values.at(inside);
+                    const double outsideValue = values.at(outside);
+                    edge.edge = edge.inside + (edge.outside - edge.inside) * (insideValue - half) / (insideValue - outsideValue);
+                    edge.found = true;
+                    edge.done = true;
+                    break;
+                }
+                point[axis] = edge.inside + edge.direction * toLattice(gap / 2);
+            }
+
+            double value;
+            if (!measured(point, value))
+            {
+                pending.push_back(point);
+                return true;
+            }
+            if (value >= half)
+            {
+                edge.inside = point[axis];
+            }
+            else
+            {
+                edge.outside = point[axis];
+                edge.bracketed = true;
+            }
+        }
+    }
+    return false;
+}
+
+bool FocusSearch::measured(const Point& point, double& value) const
+{
+    const auto found = values.find(point);
+    if (found == values.end())
+    {
+        return false;
+    }
+    value = found->second;
+    return true;
+}
+
+FocusSearch::Result FocusSearch::result() const
+{
+    Result result;
+    result.found = !values.empty();
+    const bool refined = currentPhase == Phase::Extent || currentPhase == Phase::Done;
+    result.focus = refined ? focus : bestPoint;
+    result.peak = refined ? focusValue : bestValue;
+    for (const Edge& edge : edges)
+    {
+        if (edge.found)
+        {
+            (edge.direction < 0 ? result.lower : result.upper)[edge.axis] = edge.edge;
+            (edge.direction < 0 ? result.hasLower : result.hasUpper)[edge.axis] = true;
+        }
+    }
+    result.points = values.size();
+    result.densePoints = 1;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        result.densePoints *= (size_t)((upperBound[axis] - lowerBound[axis]) / target + 1);
+    }
+    return result;
+}
+
+const char* FocusSearch::phaseName(Phase phase)
+{
+    switch (phase)
+    {
+    case Phase::Coarse:
+        return "coarse grid";
+    case Phase::Refine:
+        return "refining";
+    case Phase::Extent:
+        return "-6 dB extent";
+    case Phase::Done:
+        return "done";
+    default:
+        return "idle";
+    }
+}
+
+int32_t FocusSearch::toLattice(int32_t um) const
+{
+    return (int32_t)std::lround(um / (double)latticeUm) * latticeUm;
+}
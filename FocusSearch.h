@@ -0,0 +1,95 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef FOCUSSEARCH_H  // Include guard to prevent multiple inclusions
+#define FOCUSSEARCH_H
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "ScanPlan.h"
+
+// Adaptive search for the focus of the transducer and the -6 dB region around it. Instead of a dense grid it
+//   1. measures the coarse grid of a ScanPlan,
+//   2. repeatedly halves the step in a box of +/- the previous step around the best point so far, until the
+//      step reaches the target resolution,
+//   3. walks out from the focus along each axis in coarse steps until the value drops below half the peak,
+//      then bisects that interval down to the target resolution.
+// Points are on the 0.1 mm gantry lattice, in um; a point already measured is never visited again.
+// The caller alternates next() and report(): each point must be reported before the next one is asked for.
+class FocusSearch
+{
+public:
+    using Point = std::array<int32_t, 3>;
+
+    enum class Phase
+    {
+        Idle,
+        Coarse,
+        Refine,
+        Extent,
+        Done
+    };
+
+    struct Result
+    {
+        bool found = false;
+        Point focus = { 0, 0, 0 };  // um
+        double peak = 0;
+        bool hasLower[3] = { false, false, false };  // The value fell below peak / 2 inside the bounds
+        bool hasUpper[3] = { false, false, false };
+        double lower[3] = { 0, 0, 0 };  // um, the -6 dB edges, linearly interpolated
+        double upper[3] = { 0, 0, 0 };
+        size_t points = 0;  // Points measured
+        size_t densePoints = 0;  // Points of a grid at the target resolution over the same volume
+    };
+
+    bool start(const ScanPlan& coarse, double targetResolutionMm, std::string& error);
+    bool next(int32_t position[3]);  // The next point to measure; false when the search is done
+    void report(const int32_t position[3], double value);
+    Result result() const;
+    Phase phase() const { return currentPhase; }
+    static const char* phaseName(Phase phase);
+
+private:
+    // Walk from the focus along one axis in one direction; inside is the last point at or above half the peak
+    struct Edge
+    {
+        int axis;
+        int direction;
+        int32_t inside;
+        int32_t outside;
+        bool bracketed;  // outside holds a point below half the peak
+        bool done;
+        bool found;
+        double edge;
+    };
+
+    bool advance();  // Queues the points of the next stage; false when there are none left
+    bool startRefineLevel();
+    bool advanceEdges();
+    bool measured(const Point& point, double& value) const;
+    Point best() const;
+    int32_t toLattice(int32_t um) const;
+
+    Phase currentPhase = Phase::Idle;
+    std::map<Point, double> values;
+    std::deque<Point> pending;
+    int32_t lowerBound[3] = { 0, 0, 0 };  // um, the volume of the coarse plan
+    int32_t upperBound[3] = { 0, 0, 0 };
+    int32_t coarseStep[3] = { 0, 0, 0 };  // um, 0 for an axis with a single position
+    int32_t refineStep[3] = { 0, 0, 0 };
+    int32_t target = 0;  // um
+    Point bestPoint = { 0, 0, 0 };
+    double bestValue = 0;
+    Point focus = { 0, 0, 0 };  // The best point when the refinement ended
+    double focusValue = 0;
+    std::vector<Edge> edges;
+};
+
+#endif // FOCUSSEARCH_H
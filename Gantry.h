@@ -46,6 +46,7 @@ public:
 	void MoveTo();
 
 	void processCommandQueue();
+	ArduinoDevice* getArduino() const { return arduino; }  // Serial link of the gantry, e.g. for gantryReady
 
 public slots:
 	void onWaitTimerTimeout();
@@ -0,0 +1,98 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef LATENCYHISTOGRAM_H  // Include guard to prevent multiple inclusions
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+// Histogram of latencies with power-of-two microsecond bins: [0,1) us, [1,2) us, [2,4) us, ... , >= 2^(N-2) us.
+// Thread safe, so it can be filled from acquisition threads and printed from the GUI.
+class LatencyHistogram
+{
+public:
+    static const int binCount = 26;  // Last finite bin starts at 2^24 us (~16.8 s)
+
+    explicit LatencyHistogram(const std::string& name = "") : name(name) {}
+
+    void record(std::chrono::nanoseconds latency)
+    {
+        const int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        int bin = 0;
+        while (bin < binCount - 1 && us >= (int64_t(1) << bin))
+        {
+            bin++;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        bins[bin]++;
+        count++;
+        total += latency;
+        if (latency > maximum)
+        {
+            maximum = latency;
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bins.fill(0);
+        count = 0;
+        total = std::chrono::nanoseconds(0);
+        maximum = std::chrono::nanoseconds(0);
+    }
+
+    uint64_t samples() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return count;
+    }
+
+    // One line per non-empty bin, e.g. "  [64 us, 128 us): 12"
+    std::string toString() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ostringstream out;
+        out << name << ": " << count << " samples";
+        if (count)
+        {
+            out << ", mean " << std::chrono::duration<double, std::micro>(total).count() / count << " us"
+                << ", max " << std::chrono::duration<double, std::micro>(maximum).count() << " us";
+        }
+        for (int bin = 0; bin < binCount; bin++)
+        {
+            if (bins[bin] == 0)
+            {
+                continue;
+            }
+            out << "\n  [" << (bin == 0 ? 0 : (int64_t(1) << (bin - 1))) << " us, ";
+            if (bin == binCount - 1)
+            {
+                out << "inf)";
+            }
+            else
+            {
+                out << (int64_t(1) << bin) << " us)";
+            }
+            out << ": " << bins[bin];
+        }
+        return out.str();
+    }
+
+private:
+    std::string name;
+    mutable std::mutex mutex;
+    std::array<uint64_t, binCount> bins{};
+    uint64_t count = 0;
+    std::chrono::nanoseconds total{ 0 };
+    std::chrono::nanoseconds maximum{ 0 };
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,41 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef MAPPEDFILE_H  // Include guard to prevent multiple inclusions
+#define MAPPEDFILE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Read-only memory map of a whole file. Opening costs the same for any file size: pages are read by the
+// OS on first access, so a reader touching a few records of a 10 GB file reads only those.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    const uint8_t* data() const { return base; }
+    uint64_t size() const { return length; }
+    std::string lastError() const { return error; }
+
+private:
+    const uint8_t* base = nullptr;
+    uint64_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;  // HANDLE
+    void* mappingHandle = nullptr;  // HANDLE
+#endif
+    std::string error;
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,88 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "MinMaxPyramid.h"
+
+void MinMaxPyramid::build(const int16_t* newSamples, size_t newCount)
+{
+    samples = newSamples;
+    count = newSamples ? newCount : 0;
+
+    int levelCount = 0;
+    for (size_t bucket = firstBucket; count / bucket >= minBuckets; bucket *= levelFactor)
+    {
+        levelCount++;
+    }
+    pyramid.resize(levelCount);  // Shrinking keeps the remaining levels' storage
+
+    for (int k = 0; k < levelCount; k++)
+    {
+        Level& level = pyramid[k];
+        level.bucket = k == 0 ? firstBucket : pyramid[k - 1].bucket * levelFactor;
+        const size_t buckets = (count + level.bucket - 1) / level.bucket;  // The last bucket may be partial
+        level.minimum.resize(buckets);
+        level.maximum.resize(buckets);
+
+        if (k == 0)
+        {
+            // From the raw samples; the inner loop vectorizes
+            for (size_t b = 0; b < buckets; b++)
+            {
+                const int16_t* s = samples + b * firstBucket;
+                const size_t n = (std::min)((size_t)firstBucket, count - b * firstBucket);
+                int16_t lo = s[0];
+                int16_t hi = s[0];
+                for (size_t i = 1; i < n; i++)
+                {
+                    lo = (std::min)(lo, s[i]);
+                    hi = (std::max)(hi, s[i]);
+                }
+                level.minimum[b] = lo;
+                level.maximum[b] = hi;
+            }
+        }
+        else
+        {
+            // From the level below
+            const Level& below = pyramid[k - 1];
+            for (size_t b = 0; b < buckets; b++)
+            {
+                const size_t start = b * levelFactor;
+                const size_t end = (std::min)(start + levelFactor, below.minimum.size());
+                int16_t lo = below.minimum[start];
+                int16_t hi = below.maximum[start];
+                for (size_t i = start + 1; i < end; i++)
+                {
+                    lo = (std::min)(lo, below.minimum[i]);
+                    hi = (std::max)(hi, below.maximum[i]);
+                }
+                level.minimum[b] = lo;
+                level.maximum[b] = hi;
+            }
+        }
+    }
+}
+
+void MinMaxPyramid::clear()
+{
+    build(nullptr, 0);
+}
+
+int MinMaxPyramid::levelFor(size_t first, size_t last, int pixels) const
+{
+    if (last <= first || pixels <= 0)
+    {
+        return 0;
+    }
+    // Coarsest level with at most one bucket per pixel's worth of samples
+    const size_t samplesPerPixel = (last - first) / (size_t)pixels;
+    int level = 0;
+    while (level < levels() && pyramid[level].bucket <= samplesPerPixel)
+    {
+        level++;
+    }
+    return level;
+}
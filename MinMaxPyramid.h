@@ -0,0 +1,95 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef MINMAXPYRAMID_H  // Include guard to prevent multiple inclusions
+#define MINMAXPYRAMID_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Level-of-detail pyramid of one channel for plotting. Level 1 holds the min and max of every
+// firstBucket consecutive samples, each further level merges levelFactor buckets of the one below.
+// forEachPoint() walks the coarsest level that still gives about one bucket per pixel and emits its
+// min/max envelope, so the number of plotted points follows the plot width instead of the capture size;
+// when zoomed in to fewer than firstBucket samples per pixel the raw samples are emitted.
+// The pyramid keeps a pointer to the samples: they must outlive it (or the next build()).
+class MinMaxPyramid
+{
+public:
+    static const uint32_t firstBucket = 16;  // Samples per bucket of level 1
+    static const uint32_t levelFactor = 4;  // Buckets of level k merged into one of level k+1
+    static const size_t minBuckets = 1024;  // No level is built below this many buckets
+
+    // Rebuilds the levels for count samples; the level vectors keep their capacity across builds
+    void build(const int16_t* samples, size_t count);
+    void clear();
+
+    size_t size() const { return count; }
+    int levels() const { return (int)pyramid.size(); }  // Decimated levels, not counting the raw samples
+    uint32_t bucketSize(int level) const { return level == 0 ? 1 : pyramid[level - 1].bucket; }
+
+    // Level used to show samples [first, last) on pixels pixels: 0 for the raw samples, otherwise 1..levels()
+    int levelFor(size_t first, size_t last, int pixels) const;
+
+    // Number of points forEachPoint() emits for the same arguments, to size the destination beforehand
+    size_t pointCount(size_t first, size_t last, int pixels) const
+    {
+        last = (std::min)(last, count);
+        if (first >= last)
+        {
+            return 0;
+        }
+        const int level = levelFor(first, last, pixels);
+        if (level == 0)
+        {
+            return last - first;
+        }
+        const Level& l = pyramid[level - 1];
+        const size_t lastBucket = (std::min)((last + l.bucket - 1) / l.bucket, l.minimum.size());
+        return 2 * (lastBucket - first / l.bucket);
+    }
+
+    // Calls emit(sampleIndex, adcCounts) in increasing sampleIndex for the samples [first, last) at the
+    // detail of levelFor(); each bucket gives its min then its max at the index of its first sample
+    template <typename Emit>
+    void forEachPoint(size_t first, size_t last, int pixels, Emit emit) const
+    {
+        last = (std::min)(last, count);
+        if (first >= last)
+        {
+            return;
+        }
+        const int level = levelFor(first, last, pixels);
+        if (level == 0)
+        {
+            for (size_t i = first; i < last; i++)
+            {
+                emit(i, samples[i]);
+            }
+            return;
+        }
+        const Level& l = pyramid[level - 1];
+        const size_t lastBucket = (std::min)((last + l.bucket - 1) / l.bucket, l.minimum.size());
+        for (size_t b = first / l.bucket; b < lastBucket; b++)
+        {
+            emit(b * l.bucket, l.minimum[b]);
+            emit(b * l.bucket, l.maximum[b]);
+        }
+    }
+
+private:
+    struct Level
+    {
+        uint32_t bucket = 0;  // Samples per bucket
+        std::vector<int16_t> minimum;
+        std::vector<int16_t> maximum;
+    };
+    std::vector<Level> pyramid;  // Level k is pyramid[k - 1]
+    const int16_t* samples = nullptr;
+    size_t count = 0;
+};
+
+#endif // MINMAXPYRAMID_H
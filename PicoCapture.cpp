@@ -0,0 +1,88 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "PicoCapture.h"
+#include <cstring>
+#include "Resources/ps4000.h"  // For inputRanges and PS4000_MAX_VALUE
+#include "SampleConversion.h"
+
+PicoCapture::PicoCapture(uint32_t sampleCount, int64_t t0, int32_t dt, uint64_t index) :
+    count(sampleCount), startTime(t0), interval(dt), captureIndex(index)
+{
+}
+
+void PicoCapture::setChannel(int channel, std::shared_ptr<CaptureBuffer> buffer, int16_t range)
+{
+    if (!buffer)
+    {
+        return;
+    }
+    const int16_t* first = buffer->data();
+    setChannel(channel, std::shared_ptr<const int16_t>(std::move(buffer), first), range);  // Keeps the pooled buffer alive
+}
+
+void PicoCapture::setChannel(int channel, std::shared_ptr<const int16_t> samples, int16_t range)
+{
+    if (channel < 0 || channel >= maxChannels)
+    {
+        return;
+    }
+    channels[channel].data = std::move(samples);
+    channels[channel].range = range;
+}
+
+PicoCapture PicoCapture::copyOf(int channel, const int16_t* samples, uint32_t count, int64_t t0, int32_t dt, int16_t range, uint64_t index)
+{
+    std::shared_ptr<int16_t[]> copy(new int16_t[__max(count, 1u)]);
+    memcpy(copy.get(), samples, count * sizeof(int16_t));
+    const int16_t* first = copy.get();
+    PicoCapture capture(count, t0, dt, index);
+    capture.setChannel(channel, std::shared_ptr<const int16_t>(std::move(copy), first), range);
+    return capture;
+}
+
+uint32_t PicoCapture::channelMask() const
+{
+    uint32_t mask = 0;
+    for (int channel = 0; channel < maxChannels; channel++)
+    {
+        if (channels[channel].data)
+        {
+            mask |= 1u << channel;
+        }
+    }
+    return mask;
+}
+
+int PicoCapture::channelCount() const
+{
+    int n = 0;
+    for (const Channel& channel : channels)
+    {
+        n += channel.data ? 1 : 0;
+    }
+    return n;
+}
+
+double PicoCapture::mvPerCount(int channel) const
+{
+    return inputRanges[channels[channel].range] / (double)PS4000_MAX_VALUE;
+}
+
+int32_t PicoCapture::mvAtInteger(int channel, size_t i) const
+{
+    return adc_to_mv(channels[channel].data.get()[i], channels[channel].range);
+}
+
+void PicoCapture::toMillivolts(int channel, float* mv) const
+{
+    SampleConversion::toMillivolts(channels[channel].data.get(), mv, count, mvPerCount(channel));
+}
+
+void PicoCapture::toMillivolts(int channel, double* mv) const
+{
+    SampleConversion::toMillivolts(channels[channel].data.get(), mv, count, mvPerCount(channel));
+}
@@ -0,0 +1,94 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef PICOCAPTURE_H  // Include guard to prevent multiple inclusions
+#define PICOCAPTURE_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include "CaptureBufferPool.h"
+
+// One capture of up to four channels taken in lockstep, stored compactly: per channel the raw int16_t ADC
+// counts in one contiguous block and its range; shared by all channels the sample count and (t0, dt).
+// Time and millivolts are computed on demand, so a capture costs 2 bytes per sample per channel.
+// Copies are cheap and share the samples; a pooled buffer returns to its pool when the last copy is gone.
+class PicoCapture
+{
+public:
+    static const int maxChannels = 4;  // Channels A-D
+
+    PicoCapture() = default;
+    PicoCapture(uint32_t sampleCount, int64_t t0, int32_t dt, uint64_t index = 0);
+
+    // Adds (or replaces) a channel; the samples must hold at least size() values
+    void setChannel(int channel, std::shared_ptr<CaptureBuffer> buffer, int16_t range);
+    void setChannel(int channel, std::shared_ptr<const int16_t> samples, int16_t range);
+
+    // Copies count samples into a new standalone single-channel capture (e.g. a window of a stream)
+    static PicoCapture copyOf(int channel, const int16_t* samples, uint32_t count, int64_t t0, int32_t dt, int16_t range, uint64_t index = 0);
+
+    bool empty() const { return count == 0 || channelMask() == 0; }
+    uint32_t size() const { return count; }
+    int64_t t0() const { return startTime; }  // Time of the first sample in ns
+    int32_t dt() const { return interval; }  // Sample interval in ns
+    uint64_t index() const { return captureIndex; }  // Capture number within its acquisition
+    std::chrono::steady_clock::time_point readyTime() const { return ready; }  // When the block was read out, if known
+    void setReadyTime(std::chrono::steady_clock::time_point time) { ready = time; }
+
+    bool hasChannel(int channel) const { return channel >= 0 && channel < maxChannels && channels[channel].data != nullptr; }
+    uint32_t channelMask() const;  // Bit per channel present
+    int channelCount() const;
+    int16_t range(int channel) const { return channels[channel].range; }  // PS4000_RANGE the channel was taken with
+
+    std::span<const int16_t> raw(int channel) const { return std::span<const int16_t>(channels[channel].data.get(), count); }  // Writer view
+    const int16_t* samples(int channel) const { return channels[channel].data.get(); }
+
+    int64_t timeAt(size_t i) const { return startTime + (int64_t)i * interval; }  // ns
+    int64_t endTime() const { return count ? timeAt(count - 1) : startTime; }
+    double mvPerCount(int channel) const;
+    double mvAt(int channel, size_t i) const { return channels[channel].data.get()[i] * mvPerCount(channel); }
+    int32_t mvAtInteger(int channel, size_t i) const;  // Same integer conversion as adc_to_mv
+    void toMillivolts(int channel, float* mv) const;  // All samples at once with the SampleConversion kernels
+    void toMillivolts(int channel, double* mv) const;
+
+    // Plotter view of one channel: indexable time (in the given unit) and mV without materialising either array
+    class PlotView
+    {
+    public:
+        PlotView(const PicoCapture& capture, int channel, double timeScale) :
+            samples(capture.samples(channel)), n(capture.count), t0(capture.startTime), dt(capture.interval),
+            scale(1.0 / timeScale), mvPerCount(capture.mvPerCount(channel)) {}
+        size_t size() const { return n; }
+        double key(size_t i) const { return (t0 + (double)i * dt) * scale; }
+        double value(size_t i) const { return samples[i] * mvPerCount; }
+
+    private:
+        const int16_t* samples;
+        size_t n;
+        int64_t t0;
+        int32_t dt;
+        double scale;
+        double mvPerCount;
+    };
+    PlotView plotView(int channel, double timeScale) const { return PlotView(*this, channel, timeScale); }
+
+private:
+    struct Channel
+    {
+        std::shared_ptr<const int16_t> data;  // Aliases the owning buffer
+        int16_t range = 0;
+    };
+    std::array<Channel, maxChannels> channels;
+    uint32_t count = 0;
+    int64_t startTime = 0;
+    int32_t interval = 0;
+    uint64_t captureIndex = 0;
+    std::chrono::steady_clock::time_point ready{};
+};
+
+#endif // PICOCAPTURE_H
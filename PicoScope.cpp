@@ -1,7 +1,7 @@
 // Author: Soroosh Sanatkhani
 // Columbia University
 // Created: 1 August, 2023
-// Last Modified : 21 June, 2024
+// Last Modified : 17 October, 2026
 
 #include "stdafx.h"  // Includes precompiled header files
 #include "PicoScope.h"  // Includes the PicoScope class
@@ -10,21 +10,150 @@
 #include <chrono>
 #include <thread>
 #include "FUSMainWindow.h"  // Includes the FUSMainWindow class
+#include "Ps4000Driver.h"  // Scope backend talking to the instrument
+#include "SimulatedScopeDriver.h"  // Scope backend generating the data in software
+
+namespace
+{
+    // Waits while the consumer of the queue is behind; gives up if the queue is closed
+    template <typename T>
+    void pushWaiting(BoundedQueue<T>& queue, const T& item)
+    {
+        while (!queue.push(item, std::chrono::milliseconds(100)))
+        {
+            if (queue.isClosed())
+            {
+                break;
+            }
+        }
+    }
+}
 
 
 
 using namespace std;  // Uses the standard namespace
 
+// Gives data exactly size points without giving up its storage: the points are overwritten in place by
+// the caller, so at an unchanged size nothing is allocated. Keys written afterwards must be sorted.
+static void resizeGraphData(QCPGraphDataContainer& data, int size)
+{
+    if (data.size() == size)
+    {
+        return;
+    }
+    if (data.size() > size)
+    {
+        data.clear();  // Keeps the capacity of the underlying QVector
+    }
+    const QCPGraphData point(data.isEmpty() ? 0 : (data.constEnd() - 1)->key, 0);
+    while (data.size() < size)
+    {
+        data.add(point);  // Equal keys take the append path
+    }
+}
+
+// Channel colours as on the PicoScope software, shared by the trace and spectrum plots
+static const QColor channelColors[PicoCapture::maxChannels] = { Qt::blue, Qt::red, Qt::darkGreen, Qt::magenta };
+static const char* channelNames[PicoCapture::maxChannels] = { "A", "B", "C", "D" };
+
 // Defines the constructor of the PicoScope class
-PicoScope::PicoScope(FUSMainWindow* parent) : QObject(parent), fus_mainwindow(parent)
+PicoScope::PicoScope(FUSMainWindow* parent) : QObject(parent), fus_mainwindow(parent), driver(std::make_unique<Ps4000Driver>())
 {
     customPlot = new QCustomPlot();  // Creates a new QCustomPlot object
+    // one graph per channel kept for the lifetime of the plot
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        channelGraphs[channel] = customPlot->addGraph();
+        channelGraphs[channel]->setPen(QPen(channelColors[channel]));
+        channelGraphs[channel]->setName(QString("Channel ") + channelNames[channel]);
+        channelGraphs[channel]->data()->setAutoSqueeze(false);
+        channelGraphs[channel]->setVisible(false);
+        channelGraphs[channel]->removeFromLegend();
+    }
+    customPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);  // Horizontal zoom/drag, re-decimated by updatePlotDetail
+    customPlot->axisRect()->setRangeDrag(Qt::Horizontal);
+    customPlot->axisRect()->setRangeZoom(Qt::Horizontal);
+    connect(customPlot->xAxis, QOverload<const QCPRange&>::of(&QCPAxis::rangeChanged), this, &PicoScope::updatePlotDetail);
+
+    // Every redraw goes through the scheduler, which prepares the newest data at most maxRate times per second
+    replotScheduler = new ReplotScheduler(customPlot, this);
+    replotScheduler->setFrameCallback([this]() { plotPico(); });
+
+    // Magnitude spectrum of the captures, computed on spectrumAnalyzer's worker thread
+    spectrumPlot = new QCustomPlot();
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        spectrumGraphs[channel] = spectrumPlot->addGraph();
+        spectrumGraphs[channel]->setPen(QPen(channelColors[channel]));
+        spectrumGraphs[channel]->setName(QString("Channel ") + channelNames[channel]);
+        spectrumGraphs[channel]->data()->setAutoSqueeze(false);
+        spectrumGraphs[channel]->setVisible(false);
+        spectrumGraphs[channel]->removeFromLegend();
+    }
+    spectrumPlot->xAxis->setLabel("kHz");
+    spectrumPlot->yAxis->setLabel("dB re 1 mV");
+    spectrumPlot->yAxis->setRange(-80, 60);
+    spectrumPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    connect(spectrumPlot->xAxis, QOverload<const QCPRange&>::of(&QCPAxis::rangeChanged), this, &PicoScope::updateSpectrumDetail);
+    spectrumScheduler = new ReplotScheduler(spectrumPlot, this);
+    spectrumScheduler->setFrameCallback([this]() { plotSpectrum(); });
+    // Waterfall of the spectra of the first channel, newest row at the top
+    waterfallPlot = new QCustomPlot();
+    waterfallMap = new QCPColorMap(waterfallPlot->xAxis, waterfallPlot->yAxis);
+    waterfallMap->data()->setSize((int)waterfall.columns(), (int)waterfall.rows());  // Allocated once, cells are overwritten in place
+    waterfallMap->setGradient(QCPColorGradient::gpJet);
+    waterfallMap->setDataRange(QCPRange(-80, 60));
+    waterfallMap->setInterpolate(false);
+    waterfallPlot->xAxis->setLabel("kHz");
+    waterfallPlot->yAxis->setLabel("Spectra ago");
+    waterfallPlot->yAxis->setRangeReversed(true);
+    waterfallPlot->yAxis->setRange(0, (double)waterfall.rows() - 1);
+    waterfallPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    waterfallPlot->axisRect()->setRangeDrag(Qt::Horizontal);
+    waterfallPlot->axisRect()->setRangeZoom(Qt::Horizontal);
+
+    // Slice of the field map of the running scan, one cell per point as fieldMapThread computes it
+    fieldMapView = new FieldMapView(fieldMap);
+    connect(this, &PicoScope::fieldMapReset, fieldMapView, &FieldMapView::reset);
+    connect(this, &PicoScope::fieldMapPointAdded, fieldMapView, &FieldMapView::pointAdded);
+
+    spectrumAnalyzer.start([this](SpectrumAnalyzer::Spectrum& spectrum)
+        {
+            for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+            {
+                if ((spectrum.channelMask >> channel) & 1)
+                {
+                    waterfall.addRow(spectrum.db[channel], spectrum.binHz);  // Every computed spectrum becomes a row
+                    break;
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(spectrumMutex);
+                std::swap(latestSpectrum, spectrum);  // The worker refills the previous buffers next time
+                newSpectrum = true;
+            }
+            if (!spectrumPending.exchange(true))
+            {
+                QMetaObject::invokeMethod(this, "requestSpectrumPlot", Qt::QueuedConnection);
+            }
+        });
     y_limit = 0;
 }
 
 // Defines the destructor of the PicoScope class
 PicoScope::~PicoScope()
 {
+    stopAcquisition();
+    stopStreaming();
+    spectrumAnalyzer.stop();
+    stopScanStore();
+    scanWriter.close();
+    scanExportQueue.close();
+    if (scanExportThread.joinable())
+    {
+        scanExportThread.join();
+    }
+    stopFieldMap();
 }
 
 // Defines the function to read the parameters
@@ -40,10 +169,29 @@ PicoScope::PicoScope_Vars PicoScope::initializePicoScope()
 {
     if (picoVar.status_open != 0)
     {
-        picoVar.status_open = ps4000OpenUnit(&(picoVar.unit.handle));
+        // The simulated scope stands in for the instrument and produces the bursts set in the waveform generator panel
+        if (fus_mainwindow->getSimulatedScopeValue())
+        {
+            SimulatedScopeDriver::Settings settings;
+            settings.carrierHz = fus_mainwindow->getFrequencyValue();
+            settings.amplitudeMv = fus_mainwindow->getAmplitudeValue() / 2.0;
+            settings.pulseDurationS = fus_mainwindow->getPulseDurationValue() / 1000.0;
+            settings.prfHz = __max(fus_mainwindow->getPRFValue(), 1u);
+            setDriver(std::make_unique<SimulatedScopeDriver>(settings));
+        }
+        else
+        {
+            setDriver(std::make_unique<Ps4000Driver>());
+        }
+        fus_mainwindow->emitPrintSignal(QString("Scope driver: ") + driver->name());
+
+        picoVar.status_open = driver->openUnit(&(picoVar.unit.handle));
         picoVar.status_close = 1;
-        get_info(&picoVar.unit);
-        picoVar.unit.channelSettings[1].enabled = FALSE;
+        driver->getInfo(&picoVar.unit);
+        for (int channel = 1; channel < MAX_CHANNELS; channel++)
+        {
+            picoVar.unit.channelSettings[channel].enabled = FALSE;
+        }
         picoVar.unit.channelSettings[0].enabled = TRUE;
         picoVar.unit.channelSettings[0].DCcoupled = TRUE;
         picoVar.status_setBuffer = 0;
@@ -56,57 +204,63 @@ PicoScope::PicoScope_Vars PicoScope::initializePicoScope()
     return picoVar;
 }
 
-void PicoScope::readBlockPicoScope()
+// Replaces the scope backend; ignored while the unit is open
+void PicoScope::setDriver(std::unique_ptr<ScopeDriver> newDriver)
 {
-    fus_mainwindow->emitPrintSignal("Initialize reading...");
-    ///////////// Set parameters ///////////////////
-    SetParameters(readParameters().Timebase, 1, TRUE, 0, readParameters().Buffer);
-    fus_mainwindow->emitPrintSignal("Parameters set.");
-    switch (fus_mainwindow->getRangeValue())
-    {
-    case 0:
-        picoVar.unit.channelSettings[0].range = PS4000_10MV;
-        break;
-    case 1:
-        picoVar.unit.channelSettings[0].range = PS4000_20MV;
-        break;
-    case 2:
-        picoVar.unit.channelSettings[0].range = PS4000_50MV;
-        break;
-    case 3:
-        picoVar.unit.channelSettings[0].range = PS4000_100MV;
-        break;
-    case 4:
-        picoVar.unit.channelSettings[0].range = PS4000_200MV;
-        break;
-    case 5:
-        picoVar.unit.channelSettings[0].range = PS4000_500MV;
-        break;
-    case 6:
-        picoVar.unit.channelSettings[0].range = PS4000_1V;
-        break;
-    case 7:
-        picoVar.unit.channelSettings[0].range = PS4000_2V;
-        break;
-    case 8:
-        picoVar.unit.channelSettings[0].range = PS4000_5V;
-        break;
-    case 9:
-        picoVar.unit.channelSettings[0].range = PS4000_10V;
-        break;
-    case 10:
-        picoVar.unit.channelSettings[0].range = PS4000_20V;
-        break;
-    case 11:
-        picoVar.unit.channelSettings[0].range = PS4000_50V;
-        break;
-    }
-    picoData.MV_numbers.clear();
-    picoData.t_numbers.clear();
-    ////////////////////////////////////////////////
+    if (picoVar.status_open == 0 || !newDriver)
+    {
+        return;
+    }
+    driver = std::move(newDriver);
+}
+
+// Sets enable, coupling and range of every channel the unit has from the channel controls
+void PicoScope::applyChannels()
+{
+    for (int channel = 0; channel < MAX_CHANNELS; channel++)
+    {
+        CHANNEL_SETTINGS& settings = picoVar.unit.channelSettings[channel];
+        if (channel >= picoVar.unit.channelCount)
+        {
+            settings.enabled = FALSE;
+            continue;
+        }
+        settings.enabled = fus_mainwindow->getChannelEnabledValue(channel) ? TRUE : FALSE;
+        settings.DCcoupled = fus_mainwindow->getChannelDCCoupledValue(channel) ? TRUE : FALSE;
+        settings.range = (int16_t)(PS4000_10MV + fus_mainwindow->getChannelRangeValue(channel));  // The combo boxes list the ranges in PS4000_RANGE order
+    }
+}
+
+// Bit per channel enabled by applyChannels
+uint32_t PicoScope::enabledChannelMask() const
+{
+    uint32_t mask = 0;
+    for (int channel = 0; channel < __min((int)picoVar.unit.channelCount, MAX_CHANNELS); channel++)
+    {
+        if (picoVar.unit.channelSettings[channel].enabled)
+        {
+            mask |= 1u << channel;
+        }
+    }
+    return mask;
+}
+
+// Sets up the rising-edge trigger on channel A from TriggerVoltage_lineEdit
+void PicoScope::applyTrigger()
+{
+    if (!picoVar.unit.channelSettings[PS4000_CHANNEL_A].enabled)
+    {
+        // Channel A is the trigger source; without it the block starts immediately
+        fus_mainwindow->emitPrintSignal("Channel A disabled, capturing without trigger.");
+        driver->setDefaults(&picoVar.unit);
+        struct tTriggerDirections directions;
+        struct tPwq pulseWidth;
+        memset(&directions, 0, sizeof(struct tTriggerDirections));
+        memset(&pulseWidth, 0, sizeof(struct tPwq));
+        driver->setTrigger(picoVar.unit.handle, NULL, 0, NULL, 0, &directions, &pulseWidth, 0, 0, 0);
+        return;
+    }
 
-    //////////// Setting up the trigger /////////
-    /////////////////////////////////////////////
     uint16_t trigger_thr = fus_mainwindow->getTriggerVoltageValue();
     int16_t	triggerVoltage = mv_to_adc(trigger_thr, picoVar.unit.channelSettings[PS4000_CHANNEL_A].range); // ChannelInfo stores ADC counts
 
@@ -136,190 +290,1408 @@ void PicoScope::readBlockPicoScope()
 
     memset(&pulseWidth, 0, sizeof(struct tPwq));
 
-    fus_mainwindow->emitPrintSignal("Collect block triggered...");
-        
-    SetDefaults(&picoVar.unit);
+    driver->setDefaults(&picoVar.unit);
 
     /* Trigger enabled
     * Rising edge*/
-    SetTrigger(picoVar.unit.handle, &sourceDetails, 1, &conditions, 1, &directions, &pulseWidth, 0, 0, 0);
+    driver->setTrigger(picoVar.unit.handle, &sourceDetails, 1, &conditions, 1, &directions, &pulseWidth, 0, 0, 0);
+}
 
-    ////////////////////////////////////////////////////
-    //////////// Reading a block of samples ////////////
-    int32_t i;
-    int32_t timeInterval;
-    int32_t sampleCount = readParameters().Buffer;
-    FILE* fp = NULL;
-    int32_t maxSamples;
-    int16_t* buffers[2];
-    int32_t timeIndisposed;
-    int32_t offset = 0;
+// Waits for CallBackBlock to signal blockContext; wakes up as soon as the driver reports the data ready
+// Runs on acquisitionThread and waits in short slices so that stopAcquisition() is honoured without a pending trigger
+bool PicoScope::waitForBlockReady(std::chrono::milliseconds maxWaitTime)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    while (!blockContext.wait(std::chrono::milliseconds(100)))
+    {
+        if (acquisitionStopRequested)
+        {
+            return false;
+        }
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime) >= maxWaitTime)
+        {
+            fus_mainwindow->emitPrintSignal("Timeout!");
+            return false;
+        }
+    }
+    callbackWakeupLatency.record(std::chrono::steady_clock::now() - blockContext.readyAt);
+    return true;
+}
 
-    buffers[0] = (int16_t*)malloc(sampleCount * sizeof(int16_t));
-    buffers[1] = (int16_t*)malloc(sampleCount * sizeof(int16_t));
-    picoVar.status_setBuffer = ps4000SetDataBuffers(picoVar.unit.handle, (PS4000_CHANNEL)0, buffers[0], buffers[1], sampleCount);
+// Reads a single block on the acquisition thread
+void PicoScope::readBlockPicoScope()
+{
+    startAcquisition(1);
+}
+
+// Applies the UI settings to the unit and finds a valid timebase for sampleCount samples
+void PicoScope::configureBlock(int32_t& sampleCount, int32_t& timeInterval)
+{
+    ///////////// Set parameters ///////////////////
+    SetParameters(readParameters().Timebase, 1, TRUE, 0, readParameters().Buffer);
+    fus_mainwindow->emitPrintSignal("Parameters set.");
+    applyChannels();
+    ////////////////////////////////////////////////
+
+    fus_mainwindow->emitPrintSignal("Collect block triggered...");
+    applyTrigger();
 
-    fus_mainwindow->emitPrintSignal(QString::fromStdString("ps4000SetDataBuffers(channel " + to_string(0) + "------------" + to_string(picoVar.status_setBuffer)));
+    sampleCount = readParameters().Buffer;
+    int32_t maxSamples;
 
     /*
     * Find the maximum number of samples, and the time interval (in nanoseconds), at the current timebase if it is valid.
     * If the timebase index is not valid, increment by 1 and try again.
     */
-    while (ps4000GetTimebase(picoVar.unit.handle, timebase, sampleCount, &timeInterval, oversample, &maxSamples, 0))
+    while (driver->getTimebase(picoVar.unit.handle, timebase, sampleCount, &timeInterval, oversample, &maxSamples, 0))
     {
         timebase++;
     }
 
     fus_mainwindow->emitPrintSignal(QString::fromStdString("timebase: " + to_string(timebase) + "------- oversample: " + to_string(oversample)));
+}
+
+// Starts block acquisition on a dedicated thread that owns the unit until it finishes.
+// captures <= 0 keeps capturing until stopAcquisition() is called.
+void PicoScope::startAcquisition(int captures)
+{
+    if (streamRunning)
+    {
+        fus_mainwindow->emitPrintSignal("Streaming in progress, stop the stream before reading a block.");
+        return;
+    }
+    if (acquisitionRunning)
+    {
+        fus_mainwindow->emitPrintSignal("Acquisition already running.");
+        return;
+    }
+    stopAcquisition();  // Joins the threads of a previous acquisition that ended on its own
 
-    /* Start it collecting, then wait for completion*/
-    g_ready = FALSE;
-    picoVar.status_RunBlock = ps4000RunBlock(picoVar.unit.handle, 0, sampleCount, timebase, oversample, &timeIndisposed, 0, CallBackBlock, NULL);
+    fus_mainwindow->emitPrintSignal("Initialize reading...");
+    int32_t sampleCount;
+    int32_t timeInterval;
+    configureBlock(sampleCount, timeInterval);
+    uint32_t channelMask = enabledChannelMask();
+    if (channelMask == 0)
+    {
+        fus_mainwindow->emitPrintSignal("No channel enabled.");
+        return;
+    }
+    if (capturePool.configure((size_t)sampleCount, channelMask))
+    {
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("Capture buffers: " + to_string(sampleCount) + " samples per channel"));
+    }
 
-    fus_mainwindow->emitPrintSignal(QString::fromStdString("BlockDataHandler:ps4000RunBlock ------ " + to_string(picoVar.status_RunBlock)));
+    captureQueue.reopen();
+    replotScheduler->resetCounters();
+    shownCaptureEnd = -1;  // The first frame shows the whole capture
+    acquisitionStopRequested = false;
+    acquisitionRunning = true;
+    captureConsumerThread = std::thread(&PicoScope::captureConsumerLoop, this);
+    acquisitionThread = std::thread(&PicoScope::acquisitionLoop, this, captures, sampleCount, timeInterval, channelMask);
+}
 
-    const auto maxWaitTime = std::chrono::seconds(5);
-    auto startTime = std::chrono::steady_clock::now();
-    while (!g_ready) {
-        // Check if the maximum wait time has been reached
-        auto currentTime = std::chrono::steady_clock::now();
-        auto elapsedTime = std::chrono::duration_cast<std::chrono::seconds>(currentTime - startTime);
+void PicoScope::stopAcquisition()
+{
+    acquisitionStopRequested = true;
+    if (acquisitionThread.joinable())
+    {
+        acquisitionThread.join();
+    }
+    if (captureConsumerThread.joinable())
+    {
+        captureConsumerThread.join();
+    }
+}
 
-        if (elapsedTime >= maxWaitTime) {
-            fus_mainwindow->emitPrintSignal("Timeout!");
-            break;
-        }
+void PicoScope::addCaptureConsumer(const CaptureConsumer& consumer)
+{
+    if (!acquisitionRunning)
+    {
+        captureConsumers.push_back(consumer);
+    }
+}
+
+// Runs on acquisitionThread. Two buffers alternate: as soon as a capture has been read out of the
+// scope the unit is re-armed into the other buffer, then the finished capture is queued for the consumers.
+// Buffers come from capturePool (one per enabled channel) and return to it once every consumer has released them.
+// Each slot captures into its own memory segment with its buffers registered on that segment, so re-arming
+// takes the slot's registered buffers back from the pool and registers nothing while the consumers keep up.
+void PicoScope::acquisitionLoop(int captures, int32_t sampleCount, int32_t timeInterval, uint32_t channelMask)
+{
+    std::shared_ptr<CaptureBuffer> buffers[2][MAX_CHANNELS];
+    int current = 0;
+    int32_t timeIndisposed;
+    uint64_t index = 0;
+    uint64_t registrations = 0;  // setDataBuffer(Bulk) calls
 
-        // Sleep for a short duration before checking again
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // The segments stay set across reads of the same length and channels; rapid block and streaming change
+    // them and drop the registrations. A segment's maximum counts the samples of every channel.
+    int64_t samplesPerSegment = 0;
+    for (int channel = 0; channel < MAX_CHANNELS; channel++)
+    {
+        samplesPerSegment += (channelMask & (1u << channel)) ? sampleCount : 0;
+    }
+    if (SEGMEM != 2 || samplesPerSegment != segmentedSamples)
+    {
+        int32_t maxSamples = 0;
+        SEGMEM = driver->memorySegments(picoVar.unit.handle, 2, &maxSamples) == PICO_OK && maxSamples >= samplesPerSegment ? 2 : 1;
+        segmentedSamples = SEGMEM == 2 ? samplesPerSegment : 0;
+        if (SEGMEM == 1)
+        {
+            driver->memorySegments(picoVar.unit.handle, 1, &maxSamples);  // Too long for half the memory: one segment, registered on every arm
+        }
+        driver->setNoOfCaptures(picoVar.unit.handle, 1);
+        capturePool.invalidateRegistrations();
     }
-    
+    const uint16_t segments = (uint16_t)SEGMEM;
+
+    auto arm = [&](int slot) -> bool
+    {
+        const uint16_t segment = (uint16_t)(slot % segments);
+        for (int channel = 0; channel < MAX_CHANNELS; channel++)
+        {
+            if (!(channelMask & (1u << channel)))
+            {
+                continue;
+            }
+            buffers[slot][channel] = capturePool.acquire(capturePool.registeredBuffer(segment, channel));
+            if (capturePool.needsRegistration(segment, channel, buffers[slot][channel].get()))
+            {
+                registrations++;
+                picoVar.status_setBuffer = segments > 1
+                    ? driver->setDataBufferBulk(picoVar.unit.handle, (PS4000_CHANNEL)channel, buffers[slot][channel]->data(), sampleCount, segment)
+                    : driver->setDataBuffer(picoVar.unit.handle, (PS4000_CHANNEL)channel, buffers[slot][channel]->data(), sampleCount);
+            }
+        }
+
+        /* Start it collecting */
+        blockContext.reset();
+        picoVar.status_RunBlock = driver->runBlock(picoVar.unit.handle, 0, sampleCount, timebase, oversample, &timeIndisposed, segment, CallBackBlock, &blockContext);
+        if (picoVar.status_RunBlock != PICO_OK)
+        {
+            fus_mainwindow->emitPrintSignal(QString::fromStdString("BlockDataHandler:ps4000RunBlock ------ " + to_string(picoVar.status_RunBlock)));
+            return false;
+        }
+        return true;
+    };
 
-    if (g_ready)    // g_read == TRUE --> done reading data
+    bool armed = arm(current);
+    while (armed && !acquisitionStopRequested)
     {
-        picoVar.status_GetValues = ps4000GetValues(picoVar.unit.handle, 0, (uint32_t*)&sampleCount, 1, RATIO_MODE_NONE, 0, NULL);
-        fus_mainwindow->emitPrintSignal(QString::fromStdString("BlockDataHandler:ps4000GetValues ------ " + to_string(picoVar.status_GetValues)));
-            
-        sampleCount = __min(sampleCount, BUFFER_SIZE);
+        // Single reads give up after 5 s without a trigger, continuous reads wait until stopped
+        if (!waitForBlockReady(captures > 0 ? std::chrono::milliseconds(5000) : std::chrono::milliseconds::max()))
+        {
+            fus_mainwindow->emitPrintSignal("data collection aborted");
+            break;
+        }
+
+        uint32_t nSamples = (uint32_t)sampleCount;
+        int16_t overflow = 0;
+        picoVar.status_GetValues = segments > 1
+            ? driver->getValuesBulk(picoVar.unit.handle, &nSamples, (uint16_t)current, (uint16_t)current, &overflow)
+            : driver->getValues(picoVar.unit.handle, 0, &nSamples, 1, RATIO_MODE_NONE, 0, NULL);
+        if (picoVar.status_GetValues != PICO_OK)
+        {
+            fus_mainwindow->emitPrintSignal(QString::fromStdString("BlockDataHandler:ps4000GetValues ------ " + to_string(picoVar.status_GetValues)));
+        }
 
+        PicoCapture capture(__min(nSamples, (uint32_t)sampleCount), 0, timeInterval, index++);  // No pre-trigger samples: t0 is the trigger
+        capture.setReadyTime(std::chrono::steady_clock::now());
+        for (int channel = 0; channel < MAX_CHANNELS; channel++)
+        {
+            if (buffers[current][channel])
+            {
+                capture.setChannel(channel, std::move(buffers[current][channel]), picoVar.unit.channelSettings[channel].range);
+            }
+        }
 
-        for (i = 0; i < sampleCount; i++)
+        // Re-arm into the other buffer before handing this one off
+        bool more = captures <= 0 || index < (uint64_t)captures;
+        armed = false;
+        if (more && !acquisitionStopRequested)
         {
-            picoData.t_numbers.push_back(g_times[0] + (int64_t)(i * timeInterval));
-            picoData.MV_numbers.push_back(adc_to_mv(buffers[0][i], picoVar.unit.channelSettings[PS4000_CHANNEL_A].range));
+            current = 1 - current;
+            armed = arm(current);
         }
 
-        plotPico();
+        // Waits while the consumers are behind
+        while (!captureQueue.push(capture, std::chrono::milliseconds(100)))
+        {
+            if (acquisitionStopRequested)
+            {
+                break;
+            }
+        }
     }
-    else
+
+    if ((picoVar.status_Stop = driver->stop(picoVar.unit.handle)) != PICO_OK)
     {
-        fus_mainwindow->emitPrintSignal("data collection aborted");
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("BlockDataHandler:ps4000Stop ------ " + to_string(picoVar.status_Stop)));
     }
+    fus_mainwindow->emitPrintSignal(QString::fromStdString("Capture buffers: " + to_string(registrations) + " registrations for " + to_string(index) + " captures"));
+    captureQueue.close();
+}
 
-    if ((picoVar.status_Stop = ps4000Stop(picoVar.unit.handle)) != PICO_OK)
+// Runs on captureConsumerThread: feeds every capture to the registered consumers (e.g. the writer)
+// and passes the newest one to the GUI; captures arriving faster than the GUI plots are not plotted.
+void PicoScope::captureConsumerLoop()
+{
+    PicoCapture capture;
+    while (true)
     {
-        fus_mainwindow->emitPrintSignal(QString::fromStdString("BlockDataHandler:ps4000Stop ------ 0x%08lx " + to_string(picoVar.status_Stop)));
+        if (!captureQueue.pop(capture, std::chrono::milliseconds(100)))
+        {
+            if (captureQueue.isClosed() && captureQueue.size() == 0)
+            {
+                break;  // Acquisition finished and everything has been handed out
+            }
+            continue;
+        }
+
+        for (const CaptureConsumer& consumer : captureConsumers)
+        {
+            consumer(capture);
+        }
+        spectrumAnalyzer.submit(capture);  // Never waits; a busy analyzer skips to the newest capture
+        offerScanCapture(capture);
+
+        {
+            std::lock_guard<std::mutex> lock(latestCaptureMutex);
+            if (!latestCapture.empty())
+            {
+                replotScheduler->countDropped(1);  // Replaced before the GUI picked it up
+            }
+            latestCapture = std::move(capture);
+        }
+        capture = PicoCapture();  // Drop the reference so the acquisition thread can reuse the buffer
+        if (!plotPending.exchange(true))
+        {
+            QMetaObject::invokeMethod(this, "showLatestCapture", Qt::QueuedConnection);
+        }
     }
+    fus_mainwindow->emitPrintSignal(QString::fromStdString("Plot: " + to_string(replotScheduler->framesDrawn()) + " frames drawn, " + to_string(replotScheduler->framesDropped()) + " dropped"));
+    acquisitionRunning = false;
+    emit acquisitionFinished();
+}
 
-    for (i = 0; i < 2; i++)
+// Runs on the GUI thread: makes the newest capture the plotted one. The capture keeps its pooled
+// buffer until the next one replaces it; no time/mV arrays are built.
+void PicoScope::showLatestCapture()
+{
+    plotPending = false;
+    PicoCapture capture;
+    {
+        std::lock_guard<std::mutex> lock(latestCaptureMutex);
+        capture = std::move(latestCapture);
+        latestCapture = PicoCapture();
+    }
+    if (capture.empty())
     {
-        free(buffers[i]);
+        return;
     }
+
+    std::unique_lock<std::mutex> dataLock(dataMutex);
+    picoData = std::move(capture);
+    dataLock.unlock();
+
+    requestPlot();
 }
 
-PicoScope::PicoScope_Vars PicoScope::closePicoScope()
+// Marks the plot out of date; the scheduler redraws it from picoData at its next frame
+void PicoScope::requestPlot()
 {
-    if ((picoVar.status_close != 0) && (picoVar.status_open == 0))
+    replotScheduler->requestFrame();
+}
+
+void PicoScope::setPlotFrameRate(double framesPerSecond)
+{
+    replotScheduler->setMaxRate(framesPerSecond);
+    spectrumScheduler->setMaxRate(framesPerSecond);
+    fieldMapView->setMaxRate(framesPerSecond);
+}
+
+void PicoScope::setSpectrumWindow(int window)
+{
+    if (window >= 0 && window < SpectrumAnalyzer::windowCount)
     {
-        picoVar.status_close = ps4000CloseUnit(picoVar.unit.handle);
-        fus_mainwindow->emitPrintSignal(QString::fromStdString("Unit Closed!"));
-        picoVar.status_open = 1;
-        picoVar.status_setBuffer = 0;
-        picoVar.status_RunBlock = 0;
-        picoVar.status_GetValues = 0;
-        picoVar.status_Stop = 0;
+        spectrumAnalyzer.setWindow((SpectrumAnalyzer::Window)window);
     }
-    return picoVar;
 }
 
-void PicoScope::plotPico()
+// Runs on the GUI thread once per new spectrum (coalesced); the scheduler draws it at its next frame
+void PicoScope::requestSpectrumPlot()
 {
-    QVector<double> x(picoData.t_numbers.size()), y(picoData.MV_numbers.size());
-    fus_mainwindow->emitPrintSignal(QString::fromStdString("t_numbers size = " + to_string(picoData.t_numbers.size())));
-    fus_mainwindow->emitPrintSignal(QString::fromStdString("t_numbers last element = " + to_string(picoData.t_numbers.back())));
-    double max_t = picoData.t_numbers.back() / pow(10, 6);
-    QString xLabel = "ms";
-    double scale = pow(10, 6);
-    if (max_t < 1) {
-        scale = pow(10, 3);
-        xLabel = QString::fromUtf8("\xC2\xB5s");
-        if (max_t < 0.001) {
-            scale = 1;
-            xLabel = "ns";
+    spectrumPending = false;
+    spectrumScheduler->requestFrame();
+}
+
+// Frame callback of spectrumScheduler: takes the newest spectrum and shows the graph of every channel it holds
+void PicoScope::plotSpectrum()
+{
+    updateWaterfall();
+    {
+        std::lock_guard<std::mutex> lock(spectrumMutex);
+        if (!newSpectrum)
+        {
+            return;
         }
+        std::swap(shownSpectrum, latestSpectrum);  // Both keep their storage
+        newSpectrum = false;
     }
-    else if (max_t > 1000) {
-        scale = pow(10, 9);
-        xLabel = "s";
+
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        QCPGraph* graph = spectrumGraphs[channel];
+        const bool present = (shownSpectrum.channelMask >> channel) & 1;
+        if (!present)
+        {
+            graph->data()->clear();
+        }
+        if (present != graph->visible())
+        {
+            graph->setVisible(present);
+            present ? graph->addToLegend() : graph->removeFromLegend();
+        }
     }
-    for (int i = 0; i < picoData.MV_numbers.size(); ++i)
+    spectrumPlot->legend->setVisible(shownSpectrum.channelCount() > 1);
+
+    // Show the whole band again when the FFT length or sample rate changed, otherwise keep the user's zoom
+    const double nyquistKHz = shownSpectrum.binHz * (shownSpectrum.bins() - 1) / 1000.0;
+    if (nyquistKHz != shownNyquistKHz)
     {
-        x[i] = picoData.t_numbers[i] / scale;
-        y[i] = picoData.MV_numbers[i];
+        shownNyquistKHz = nyquistKHz;
+        spectrumRangeUpdating = true;
+        spectrumPlot->xAxis->setRange(0, nyquistKHz);
+        spectrumRangeUpdating = false;
     }
-    y_limit = fus_mainwindow->getYaxisRangeValue();
-    // clear existing graphs:
-    customPlot->clearGraphs();
-    // create graph and assign data to it:
-    customPlot->addGraph();
-    customPlot->graph(0)->setData(x, y);
-    // give the axes some labels:
-    customPlot->xAxis->setLabel(xLabel);
-    customPlot->yAxis->setLabel("mV");
-    // set axes ranges, so we see all data:
-    customPlot->xAxis->setRange(0, picoData.t_numbers.back() / scale);
-    customPlot->yAxis->setRange(-y_limit, y_limit);
-    customPlot->replot();
+    updateSpectrumDetail();
 }
-void PicoScope::writePicoDataToBinaryFile(int x, int y, int z)
+
+// Empties the waterfall, e.g. at the start of a sonication run
+void PicoScope::clearWaterfall()
 {
-    // Static variable to ensure the file name is set only once per application start
-    static QString fileName;
+    waterfall.clear();
+    spectrumScheduler->requestFrame();
+}
 
-    // Check if fileName is empty, which means this is the first call to the function
-    if (fileName.isEmpty())
+// Copies the waterfall ring into the colour map's existing cells (newest row first); the map is only
+// resized if the ring dimensions differ, which they never do after construction
+void PicoScope::updateWaterfall()
+{
+    if (waterfall.version() == shownWaterfallVersion)
     {
-        // Create the directory name with the current date
-        QString dirName = "Data" + QDate::currentDate().toString("yyyyMMdd");
-        QDir dir(dirName);
-        if (!dir.exists())
+        return;
+    }
+    double spanHz = 0;
+    shownWaterfallVersion = waterfall.copyRows(waterfallCells, spanHz, -200.0f);
+
+    QCPColorMapData* data = waterfallMap->data();
+    const int columns = (int)waterfall.columns();
+    const int rows = (int)waterfall.rows();
+    if (data->keySize() != columns || data->valueSize() != rows)
+    {
+        data->setSize(columns, rows);
+    }
+    for (int age = 0; age < rows; age++)
+    {
+        const float* row = &waterfallCells[(size_t)age * columns];
+        for (int column = 0; column < columns; column++)
         {
-            dir.mkpath(".");
+            data->setCell(column, age, row[column]);
         }
+    }
 
-        // Construct the file name
-        fileName = dir.absolutePath() + "/PicoData_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".bin";
+    // Cell centres: the first column starts at 0 Hz, the last one ends at spanHz
+    const double spanKHz = spanHz / 1000.0;
+    if (spanKHz > 0 && spanKHz != shownWaterfallSpanKHz)
+    {
+        const double columnKHz = spanKHz / columns;
+        data->setRange(QCPRange(columnKHz / 2, spanKHz - columnKHz / 2), QCPRange(0, rows - 1));
+        waterfallPlot->xAxis->setRange(0, spanKHz);
+        shownWaterfallSpanKHz = spanKHz;
     }
+    waterfallPlot->replot(QCustomPlot::rpQueuedReplot);
+}
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+// Fills the spectrum graphs with the bins inside the x axis range, keeping the largest bin of every
+// pixel's worth of bins so that narrow peaks (carrier, harmonics) survive the reduction
+void PicoScope::updateSpectrumDetail()
+{
+    const size_t binCount = shownSpectrum.bins();
+    if (spectrumRangeUpdating || binCount == 0 || shownSpectrum.binHz <= 0)
     {
-        fus_mainwindow->emitPrintSignal("Unable to open file for writing: " + fileName);
         return;
     }
+    const QCPRange range = spectrumPlot->xAxis->range();
+    const double binKHz = shownSpectrum.binHz / 1000.0;
+    const size_t first = (size_t)__max(floor(range.lower / binKHz), 0.0);
+    const size_t last = (size_t)__min(__max(ceil(range.upper / binKHz) + 1, 0.0), (double)binCount);
+    const size_t pixels = (size_t)__max(spectrumPlot->axisRect()->width(), 100);
+    const size_t bucket = first < last ? __max((last - first) / pixels, (size_t)1) : 1;
+    const int points = first < last ? (int)((last - first + bucket - 1) / bucket) : 0;
 
-    QDataStream out(&file);
-    out.setByteOrder(QDataStream::LittleEndian);  // Assuming little endian for binary data
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        if (!((shownSpectrum.channelMask >> channel) & 1))
+        {
+            continue;
+        }
+        const std::vector<float>& db = shownSpectrum.db[channel];
+        QCPGraphDataContainer& data = *spectrumGraphs[channel]->data();
+        resizeGraphData(data, points);
+        QCPGraphDataContainer::iterator point = data.begin();
+        for (size_t start = first; start < last; start += bucket, ++point)
+        {
+            const size_t end = __min(start + bucket, last);
+            size_t peak = start;
+            for (size_t k = start + 1; k < end; k++)
+            {
+                if (db[k] > db[peak])
+                {
+                    peak = k;
+                }
+            }
+            point->key = peak * binKHz;
+            point->value = db[peak];
+        }
+    }
+}
 
-    // Write the header (coordinates) followed by t_numbers and MV_numbers to the binary file
-    // Since the file is opened in append mode, this will add to the end of the file
-    out << qint32(x) << qint32(y) << qint32(z); // Writing the coordinates as header
-    for (int i = 0; i < picoData.t_numbers.size(); ++i)
+// Rapid block mode: the scope memory is split into nCaptures segments so that nCaptures consecutive
+// triggers (one per waveform generator burst) are captured in a single arm and retrieved in bulk.
+// The settings are read here; the capture runs on acquisitionThread and stopAcquisition() ends it early.
+void PicoScope::readRapidBlockPicoScope(uint16_t nCaptures)
+{
+    if (streamRunning || acquisitionRunning)
+    {
+        fus_mainwindow->emitPrintSignal("Acquisition in progress, stop it before reading a rapid block.");
+        return;
+    }
+    if (nCaptures == 0)
+    {
+        return;
+    }
+    stopAcquisition();  // Joins the threads of a previous acquisition that ended on its own
+    fus_mainwindow->emitPrintSignal("Initialize rapid block reading...");
+    SetParameters(readParameters().Timebase, 1, TRUE, 0, readParameters().Buffer);
+    applyChannels();
+    uint32_t channelMask = enabledChannelMask();
+    if (channelMask == 0)
     {
-        out << qint64(picoData.t_numbers[i]); // Assuming qint64 for time values
-        out << qint64(picoData.MV_numbers[i]); // Assuming qint64 for MV values, adjust if necessary
+        fus_mainwindow->emitPrintSignal("No channel enabled.");
+        return;
     }
+    applyTrigger();
 
-    file.close();
-    fus_mainwindow->emitPrintSignal("Data written to binary file: " + fileName);
-}
\ No newline at end of file
+    // All bursts arrive within nCaptures pulse repetition periods of the waveform generator
+    unsigned int prf = __max(fus_mainwindow->getPRFValue(), 1u);
+    shownCaptureEnd = -1;  // The first frame shows the whole capture
+    acquisitionStopRequested = false;
+    acquisitionRunning = true;
+    acquisitionThread = std::thread(&PicoScope::rapidBlockLoop, this, nCaptures, readParameters().Buffer, channelMask, prf);
+}
+
+// Runs on acquisitionThread: arms the segmented capture, waits for it and reads every completed segment out
+void PicoScope::rapidBlockLoop(uint16_t nCaptures, int32_t sampleCount, uint32_t channelMask, unsigned int prf)
+{
+    int32_t timeInterval;
+    int32_t maxSamples;
+    int32_t timeIndisposed;
+
+    capturePool.invalidateRegistrations();  // The segments below replace the registered block buffer
+
+    // Split the memory into one segment per capture
+    SEGMEM = (int16_t)__min(nCaptures, (uint16_t)INT16_MAX);
+    PICO_STATUS status = driver->memorySegments(picoVar.unit.handle, (uint16_t)SEGMEM, &maxSamples);
+    fus_mainwindow->emitPrintSignal(QString::fromStdString("RapidBlockDataHandler:ps4000MemorySegments ------ " + to_string(status)));
+    if (status != PICO_OK)
+    {
+        acquisitionRunning = false;
+        emit acquisitionFinished();
+        return;
+    }
+    if (sampleCount > maxSamples)
+    {
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("Buffer reduced to " + to_string(maxSamples) + " samples per segment"));
+        sampleCount = maxSamples;
+    }
+    driver->setNoOfCaptures(picoVar.unit.handle, (uint16_t)SEGMEM);
+
+    while (driver->getTimebase(picoVar.unit.handle, timebase, sampleCount, &timeInterval, oversample, &maxSamples, 0))
+    {
+        timebase++;
+    }
+
+    blockContext.reset();
+    picoVar.status_RunBlock = driver->runBlock(picoVar.unit.handle, 0, sampleCount, timebase, oversample, &timeIndisposed, 0, CallBackBlock, &blockContext);
+    fus_mainwindow->emitPrintSignal(QString::fromStdString("RapidBlockDataHandler:ps4000RunBlock ------ " + to_string(picoVar.status_RunBlock)));
+
+    auto maxWaitTime = std::chrono::milliseconds(5000 + 1000ULL * SEGMEM / prf);
+    bool ready = waitForBlockReady(maxWaitTime);
+
+    // On a timeout or a stop keep whatever segments were completed
+    uint16_t nCompleted = (uint16_t)SEGMEM;
+    if (!ready)
+    {
+        driver->stop(picoVar.unit.handle);
+        driver->getNoOfCaptures(picoVar.unit.handle, &nCompleted);
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("Rapid block: " + to_string(nCompleted) + " of " + to_string(SEGMEM) + " captures completed"));
+    }
+
+    if (nCompleted > 0)
+    {
+        // One contiguous block for all segments; segment s of the k-th enabled channel starts at (s * nChannels + k) * sampleCount
+        std::vector<int> enabled;
+        for (int channel = 0; channel < MAX_CHANNELS; channel++)
+        {
+            if (channelMask & (1u << channel))
+            {
+                enabled.push_back(channel);
+            }
+        }
+        const size_t nChannels = enabled.size();
+        std::shared_ptr<int16_t[]> block(new int16_t[(size_t)nCompleted * nChannels * sampleCount]);
+        for (uint16_t segment = 0; segment < nCompleted; segment++)
+        {
+            for (size_t k = 0; k < nChannels; k++)
+            {
+                driver->setDataBufferBulk(picoVar.unit.handle, (PS4000_CHANNEL)enabled[k], block.get() + ((size_t)segment * nChannels + k) * sampleCount, sampleCount, segment);
+            }
+        }
+
+        std::vector<int16_t> overflow(nCompleted);
+        uint32_t nSamples = (uint32_t)sampleCount;
+        picoVar.status_GetValues = driver->getValuesBulk(picoVar.unit.handle, &nSamples, 0, nCompleted - 1, overflow.data());
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("RapidBlockDataHandler:ps4000GetValuesBulk ------ " + to_string(picoVar.status_GetValues)));
+
+        std::vector<PicoCapture> segments;
+        for (uint16_t segment = 0; segment < nCompleted; segment++)
+        {
+            PicoCapture capture(__min(nSamples, (uint32_t)sampleCount), 0, timeInterval, segment);
+            for (size_t k = 0; k < nChannels; k++)
+            {
+                std::shared_ptr<const int16_t> samples(block, block.get() + ((size_t)segment * nChannels + k) * sampleCount);
+                capture.setChannel(enabled[k], std::move(samples), picoVar.unit.channelSettings[enabled[k]].range);
+            }
+            segments.push_back(std::move(capture));
+        }
+        spectrumAnalyzer.submit(segments.back());
+
+        // Show the last burst
+        std::unique_lock<std::mutex> dataLock(dataMutex);
+        picoData = segments.back();
+        rapidData = std::move(segments);
+        dataLock.unlock();
+        QMetaObject::invokeMethod(this, "requestPlot", Qt::QueuedConnection);
+
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("Captured " + to_string(nCompleted) + " segments of " + to_string(nSamples) + " samples"));
+    }
+    else
+    {
+        fus_mainwindow->emitPrintSignal("data collection aborted");
+    }
+
+    if ((picoVar.status_Stop = driver->stop(picoVar.unit.handle)) != PICO_OK)
+    {
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("RapidBlockDataHandler:ps4000Stop ------ " + to_string(picoVar.status_Stop)));
+    }
+
+    // Back to a single segment for block mode
+    SEGMEM = 1;
+    driver->memorySegments(picoVar.unit.handle, 1, &maxSamples);
+    driver->setNoOfCaptures(picoVar.unit.handle, 1);
+    acquisitionRunning = false;
+    emit acquisitionFinished();
+}
+
+PicoScope::PicoScope_Vars PicoScope::closePicoScope()
+{
+    stopAcquisition();
+    stopStreaming();
+    if ((picoVar.status_close != 0) && (picoVar.status_open == 0))
+    {
+        picoVar.status_close = driver->closeUnit(picoVar.unit.handle);
+        capturePool.invalidateRegistrations();
+        SEGMEM = 0;  // Unknown until the next read sets it
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("Unit Closed!"));
+        if (callbackWakeupLatency.samples())
+        {
+            fus_mainwindow->emitPrintSignal(QString::fromStdString(callbackWakeupLatency.toString()));
+            callbackWakeupLatency.clear();
+        }
+        picoVar.status_open = 1;
+        picoVar.status_setBuffer = 0;
+        picoVar.status_RunBlock = 0;
+        picoVar.status_GetValues = 0;
+        picoVar.status_Stop = 0;
+    }
+    return picoVar;
+}
+
+// Frame callback of replotScheduler, on the GUI thread: takes picoData as the plotted capture, rebuilds its
+// min/max pyramids and shows the graph of every channel it holds; the points themselves are filled in by
+// updatePlotDetail and the scheduler queues the replot
+void PicoScope::plotPico()
+{
+    std::unique_lock<std::mutex> dataLock(dataMutex);
+    if (picoData.empty())
+    {
+        return;
+    }
+    plottedCapture = picoData;  // Shares the samples; the pyramids point into them
+    dataLock.unlock();
+
+    double max_t = plottedCapture.endTime() / pow(10, 6);
+    QString xLabel = "ms";
+    double scale = pow(10, 6);
+    if (max_t < 1) {
+        scale = pow(10, 3);
+        xLabel = QString::fromUtf8("\xC2\xB5s");
+        if (max_t < 0.001) {
+            scale = 1;
+            xLabel = "ns";
+        }
+    }
+    else if (max_t > 1000) {
+        scale = pow(10, 9);
+        xLabel = "s";
+    }
+    plotScale = scale;
+    y_limit = fus_mainwindow->getYaxisRangeValue();
+    // show the graphs of the channels in the capture, hide the others:
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        QCPGraph* graph = channelGraphs[channel];
+        const bool present = plottedCapture.hasChannel(channel);
+        if (present)
+        {
+            plotPyramids[channel].build(plottedCapture.samples(channel), plottedCapture.size());
+        }
+        else
+        {
+            plotPyramids[channel].clear();
+            graph->data()->clear();
+        }
+        if (present != graph->visible())
+        {
+            graph->setVisible(present);
+            present ? graph->addToLegend() : graph->removeFromLegend();
+        }
+    }
+    customPlot->legend->setVisible(plottedCapture.channelCount() > 1);
+    // give the axes some labels:
+    customPlot->xAxis->setLabel(xLabel);
+    customPlot->yAxis->setLabel("mV");
+    // Show the whole capture again when its length or time base changed, otherwise keep the user's zoom
+    if (plottedCapture.endTime() != shownCaptureEnd || plottedCapture.dt() != shownCaptureDt)
+    {
+        shownCaptureEnd = plottedCapture.endTime();
+        shownCaptureDt = plottedCapture.dt();
+        plotRangeUpdating = true;  // The data is filled in once below, not from rangeChanged
+        customPlot->xAxis->setRange(0, plottedCapture.endTime() / scale);
+        plotRangeUpdating = false;
+    }
+    if (y_limit != shownYLimit)
+    {
+        shownYLimit = y_limit;
+        customPlot->yAxis->setRange(-y_limit, y_limit);
+    }
+    updatePlotDetail();
+}
+
+// Fills the graphs with the part of the plotted capture inside the x axis range, at about two points
+// per pixel (min/max envelope) or with the raw samples once zoomed in far enough. Connected to the
+// x axis rangeChanged signal, so zooming and dragging re-decimate before QCustomPlot replots.
+// The points are written straight into each graph's data container, already sorted, with no
+// intermediate vectors; repeated captures of the same size reuse the container's storage.
+void PicoScope::updatePlotDetail()
+{
+    if (plotRangeUpdating || plottedCapture.empty())
+    {
+        return;
+    }
+    const QCPRange range = customPlot->xAxis->range();
+    const double dt = plottedCapture.dt() > 0 ? plottedCapture.dt() : 1;
+    const double firstIndex = floor((range.lower * plotScale - plottedCapture.t0()) / dt);
+    const double lastIndex = ceil((range.upper * plotScale - plottedCapture.t0()) / dt) + 1;
+    const size_t first = (size_t)__max(firstIndex, 0.0);
+    const size_t last = (size_t)__min(__max(lastIndex, 0.0), (double)plottedCapture.size());
+    const int pixels = __max(customPlot->axisRect()->width(), 100);  // Before the first show the rect is not laid out
+
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        if (!plottedCapture.hasChannel(channel))
+        {
+            continue;
+        }
+        const MinMaxPyramid& pyramid = plotPyramids[channel];
+        PicoCapture::PlotView view = plottedCapture.plotView(channel, plotScale);
+        const double mvPerCount = plottedCapture.mvPerCount(channel);
+        QCPGraphDataContainer& data = *channelGraphs[channel]->data();
+        resizeGraphData(data, (int)pyramid.pointCount(first, last, pixels));
+        QCPGraphDataContainer::iterator point = data.begin();
+        pyramid.forEachPoint(first, last, pixels, [&](size_t i, int16_t counts)
+            {
+                point->key = view.key(i);
+                point->value = counts * mvPerCount;
+                ++point;
+            });
+    }
+}
+// Queues the capture as one record of the session's scan data file; the file is opened on the first call
+// and stays open, and scanWriter serializes and writes the records on its own thread
+bool PicoScope::writeScanCapture(int x, int y, int z, const PicoCapture& capture)
+{
+    if (capture.empty())
+    {
+        fus_mainwindow->emitPrintSignal(QString("Scan data not written at (%1, %2, %3): no capture").arg(x).arg(y).arg(z));
+        return false;
+    }
+    if (!scanWriter.isOpen())
+    {
+        // Create the directory name with the current date
+        QString dirName = "Data" + QDate::currentDate().toString("yyyyMMdd");
+        QDir dir(dirName);
+        if (!dir.exists())
+        {
+            dir.mkpath(".");
+        }
+
+        // Construct the file name
+        QString fileName = dir.absolutePath() + "/PicoData_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".bin";
+        scanWriter.setCompression(fus_mainwindow->getCompressDataValue());
+        if (!scanWriter.open(std::filesystem::path(fileName.toStdWString()), scanFileHeader(capture)))
+        {
+            fus_mainwindow->emitPrintSignal(QString::fromStdString(scanWriter.lastError()));
+            return false;
+        }
+        scanIntervalNs = capture.dt();
+        scanSamplesPerRecord = capture.size();
+        fus_mainwindow->emitPrintSignal("Writing scan data to binary file: " + fileName);
+        scanBasePath = std::filesystem::path(fileName.toStdWString()).replace_extension();
+    }
+
+    // Readers and exports take the time base and record length from the file header
+    if (capture.dt() != scanIntervalNs || capture.size() != scanSamplesPerRecord)
+    {
+        fus_mainwindow->emitPrintSignal(QString("Scan data not written at (%1, %2, %3): %4 samples at %5 ns, the file holds %6 samples at %7 ns")
+            .arg(x).arg(y).arg(z).arg(capture.size()).arg(capture.dt()).arg(scanSamplesPerRecord).arg(scanIntervalNs));
+        return false;
+    }
+
+    // Conversion to mV and the writes into the exports run on scanExportThread
+    if (scanVolumesPending)
+    {
+        createScanVolumes(capture);
+    }
+
+    // The record is handed to scanStoreThread: the writer and the export and field map threads apply their
+    // back-pressure there. A caller that keeps scanRecordsPending() below maxScanRecordsPending (as the scan
+    // does) never waits here; otherwise this waits for room rather than lose the record.
+    if (!scanStoreThread.joinable())
+    {
+        scanStoreQueue.reopen();
+        scanStoreThread = std::thread(&PicoScope::scanStoreLoop, this);
+    }
+    ScanExportItem item{ x, y, z, capture };
+    item.exported = scanExportThread.joinable();
+    item.mapped = fieldMapThread.joinable();
+    scanRecordsInFlight++;
+    if (!scanStoreQueue.push(std::move(item), std::chrono::milliseconds(10000)))
+    {
+        scanRecordsInFlight--;
+        fus_mainwindow->emitPrintSignal(QString("Scan data not written at (%1, %2, %3): storage accepted no record for 10 s")
+            .arg(x).arg(y).arg(z));
+        return false;
+    }
+    return true;
+}
+
+void PicoScope::scanStoreLoop()
+{
+    ScanExportItem item;
+    while (true)
+    {
+        if (!scanStoreQueue.pop(item, std::chrono::milliseconds(100)))
+        {
+            if (scanStoreQueue.isClosed() && scanStoreQueue.size() == 0)
+            {
+                break;
+            }
+            continue;
+        }
+        // Record header (coordinates, time base, ranges) followed by the raw ADC counts of every captured channel
+        const bool written = scanWriter.writeCapture({ item.x, item.y, item.z }, item.capture);
+        if (!written)
+        {
+            fus_mainwindow->emitPrintSignal(QString::fromStdString("Scan data not written: " + scanWriter.lastError()));
+        }
+        if (item.exported)
+        {
+            pushWaiting(scanExportQueue, item);
+        }
+        if (item.mapped)
+        {
+            pushWaiting(fieldMapQueue, item);
+        }
+        item = ScanExportItem();
+        scanRecordsInFlight--;
+        emit scanRecordStored(written);  // Queued to the GUI thread
+    }
+}
+
+// Hands the queued records on to the writer, the exports and the field map, then joins scanStoreThread
+void PicoScope::stopScanStore()
+{
+    scanStoreQueue.close();
+    if (scanStoreThread.joinable())
+    {
+        scanStoreThread.join();
+    }
+}
+
+// Queues picoData as one record of the session's scan data file
+void PicoScope::writePicoDataToBinaryFile(int x, int y, int z)
+{
+    writeScanCapture(x, y, z, currentCapture());
+}
+
+PicoCapture PicoScope::currentCapture()
+{
+    std::lock_guard<std::mutex> lock(dataMutex);
+    return picoData;  // Shares the samples, so the lock is not held while writing
+}
+
+// The next capture read out of the scope after notBefore (e.g. once the gantry has arrived) is emitted as
+// scanCaptureReady; a later request replaces an unanswered one
+void PicoScope::requestScanCapture(std::chrono::steady_clock::time_point notBefore)
+{
+    std::lock_guard<std::mutex> lock(scanCaptureMutex);
+    scanCaptureRequested = true;
+    scanCaptureNotBefore = notBefore;
+}
+
+void PicoScope::cancelScanCapture()
+{
+    std::lock_guard<std::mutex> lock(scanCaptureMutex);
+    scanCaptureRequested = false;
+}
+
+// Runs on captureConsumerThread
+void PicoScope::offerScanCapture(const PicoCapture& capture)
+{
+    {
+        std::lock_guard<std::mutex> lock(scanCaptureMutex);
+        if (!scanCaptureRequested || capture.readyTime() < scanCaptureNotBefore)
+        {
+            return;
+        }
+        scanCaptureRequested = false;
+    }
+    QMetaObject::invokeMethod(this, [this, capture]() { emit scanCaptureReady(capture); }, Qt::QueuedConnection);
+}
+
+// Lays out and preallocates the NPY/MAT exports of a gridded scan from the grid and its first capture
+void PicoScope::createScanVolumes(const PicoCapture& first)
+{
+    scanVolumesPending = false;
+    scanExportQueue.close();  // Finishes the exports of a previous grid
+    if (scanExportThread.joinable())
+    {
+        scanExportThread.join();
+    }
+    const bool wanted[2] = { fus_mainwindow->getExportNpyValue(), fus_mainwindow->getExportMatValue() };
+    const ScanVolumeFile::Format formats[2] = { ScanVolumeFile::Format::Npy, ScanVolumeFile::Format::Mat };
+    bool created = false;
+    for (int k = 0; k < 2; k++)
+    {
+        if (!wanted[k])
+        {
+            continue;
+        }
+        if (!scanVolumes[k].create(scanBasePath, formats[k], scanGrid, first))
+        {
+            fus_mainwindow->emitPrintSignal(QString::fromStdString("Export not created: " + scanVolumes[k].lastError()));
+            continue;
+        }
+        for (const std::filesystem::path& path : scanVolumes[k].paths())
+        {
+            fus_mainwindow->emitPrintSignal("Exporting scan to " + QString::fromStdWString(path.wstring()));
+        }
+        created = true;
+    }
+    if (created)
+    {
+        scanExportTimes.clear();
+        scanExportQueue.reopen();
+        scanExportThread = std::thread(&PicoScope::scanExportLoop, this);
+    }
+}
+
+void PicoScope::scanExportLoop()
+{
+    ScanExportItem item;
+    while (true)
+    {
+        if (!scanExportQueue.pop(item, std::chrono::milliseconds(100)))
+        {
+            if (scanExportQueue.isClosed() && scanExportQueue.size() == 0)
+            {
+                break;  // closeScanData and every record stored
+            }
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        for (ScanVolumeFile& volume : scanVolumes)
+        {
+            if (volume.isOpen() && !volume.write(item.x, item.y, item.z, item.capture))
+            {
+                fus_mainwindow->emitPrintSignal(QString::fromStdString("Export skipped a point: " + volume.lastError()));
+            }
+        }
+        scanExportTimes.record(std::chrono::steady_clock::now() - start);
+        item = ScanExportItem();  // Releases the capture buffer
+    }
+}
+
+void PicoScope::fieldMapLoop()
+{
+    ScanExportItem item;
+    while (true)
+    {
+        if (!fieldMapQueue.pop(item, std::chrono::milliseconds(100)))
+        {
+            if (fieldMapQueue.isClosed() && fieldMapQueue.size() == 0)
+            {
+                break;
+            }
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        if (fieldMap.add(item.x, item.y, item.z, item.capture))
+        {
+            emit fieldMapPointAdded(item.x, item.y, item.z);  // Queued to the GUI thread
+        }
+        fieldMapTimes.record(std::chrono::steady_clock::now() - start);
+        item = ScanExportItem();
+    }
+}
+
+void PicoScope::stopFieldMap()
+{
+    fieldMapQueue.close();
+    if (fieldMapThread.joinable())
+    {
+        fieldMapThread.join();
+    }
+}
+
+// Describes the session in the scan data file header: the unit and channel settings, the trigger and the
+// waveform generator parameters as currently set, and the time base, length and channels of the first record
+ScanDataFormat::FileHeader PicoScope::scanFileHeader(const PicoCapture& first)
+{
+    ScanDataFormat::FileHeader header = ScanDataFormat::makeFileHeader();
+    header.createdUnixMs = QDateTime::currentMSecsSinceEpoch();
+
+    const char* simulated = dynamic_cast<SimulatedScopeDriver*>(driver.get()) ? " (simulated)" : "";
+    snprintf(header.deviceModel, sizeof(header.deviceModel), "PS%d%s", (int)picoVar.unit.model, simulated);
+    header.maxAdcValue = PS4000_MAX_VALUE;
+    for (int range = 0; range < PS4000_MAX_RANGES; range++)
+    {
+        header.rangeMillivolts[range] = inputRanges[range];
+    }
+    header.timebase = timebase;
+    header.intervalNs = first.dt();
+    header.samplesPerRecord = first.size();
+    header.channelMask = (uint16_t)first.channelMask();
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        const CHANNEL_SETTINGS& settings = picoVar.unit.channelSettings[channel];
+        header.range[channel] = first.hasChannel(channel) ? first.range(channel) : (int16_t)settings.range;
+        header.dcCoupled[channel] = settings.DCcoupled;
+    }
+
+    // Same trigger as applyTrigger: channel A, rising edge, only when channel A is enabled
+    header.triggerEnabled = (header.channelMask & 1) != 0;
+    header.triggerChannel = PS4000_CHANNEL_A;
+    header.triggerDirection = ScanDataFormat::Rising;
+    header.triggerThresholdMv = fus_mainwindow->getTriggerVoltageValue();
+
+    header.waveformFrequencyHz = fus_mainwindow->getFrequencyValue();
+    header.waveformAmplitudeMv = fus_mainwindow->getAmplitudeValue();
+    header.waveformPulseDurationMs = fus_mainwindow->getPulseDurationValue();
+    header.waveformDutyCycle = fus_mainwindow->getDutyCycleValue();
+    header.waveformPrfHz = fus_mainwindow->getPRFValue();
+    header.waveformLengthS = fus_mainwindow->getLengthValue();
+    return header;
+}
+
+// Waits until every queued record is on disk and reports the writer throughput
+void PicoScope::flushScanData()
+{
+    if (!scanWriter.isOpen())
+    {
+        return;
+    }
+    if (!scanWriter.flush())
+    {
+        fus_mainwindow->emitPrintSignal(QString::fromStdString(scanWriter.lastError()));
+    }
+    ScanDataWriter::Stats stats = scanWriter.stats();
+    fus_mainwindow->emitPrintSignal(QString::fromStdString(
+        "Scan data: " + to_string(stats.records) + " records, " + to_string(stats.bytesWritten / 1000000.0) + " MB, " +
+        to_string(stats.bytesPerSecond() / 1e6) + " MB/s sustained, " + to_string(stats.diskBytesPerSecond() / 1e6) + " MB/s while writing"));
+    if (stats.compressThreads)
+    {
+        fus_mainwindow->emitPrintSignal(QString::fromStdString(
+            "Compression: ratio " + to_string(stats.compressionRatio()) + " (" + to_string(stats.rawBytes / 1000000.0) + " MB raw), " +
+            to_string(stats.compressBytesPerSecond() / 1e6) + " MB/s per thread on " + to_string(stats.compressThreads) + " threads"));
+    }
+}
+
+// Flushes and closes the scan data file and the exports; the next record starts a new file
+void PicoScope::closeScanData()
+{
+    stopScanStore();
+    flushScanData();
+    scanWriter.close();
+    scanExportQueue.close();  // The export thread finishes the queued records first
+    if (scanExportThread.joinable())
+    {
+        scanExportThread.join();
+        fus_mainwindow->emitPrintSignal(QString::fromStdString(scanExportTimes.toString()));
+    }
+    for (ScanVolumeFile& volume : scanVolumes)
+    {
+        volume.close();
+    }
+
+    // The field map stays in memory for queries until the next gridded scan
+    if (fieldMapThread.joinable())
+    {
+        stopFieldMap();
+        fus_mainwindow->emitPrintSignal(QString::fromStdString(fieldMapTimes.toString()));
+        std::filesystem::path path;
+        std::string error;
+        if (fieldMap.pointsMeasured() == 0)
+        {
+            fus_mainwindow->emitPrintSignal("Field map: no point measured");
+        }
+        else if (!fieldMap.save(scanBasePath, path, error))
+        {
+            fus_mainwindow->emitPrintSignal(QString::fromStdString("Field map not saved: " + error));
+        }
+        else
+        {
+            fus_mainwindow->emitPrintSignal("Field map saved to " + QString::fromStdWString(path.wstring()));
+            const ScanGrid grid = fieldMap.getGrid();
+            for (int metric = 0; metric < FieldMap::MetricCount; metric++)
+            {
+                uint32_t index[3];
+                float value;
+                if (fieldMap.maximum((FieldMap::Metric)metric, index, value))
+                {
+                    fus_mainwindow->emitPrintSignal(QString("  max %1: %2 %3 at (%4, %5, %6) mm").arg(FieldMap::metricName((FieldMap::Metric)metric))
+                        .arg(value, 0, 'g', 4).arg(FieldMap::metricUnit((FieldMap::Metric)metric))
+                        .arg(grid.position(0, index[0]) / 1000.0, 0, 'f', 1).arg(grid.position(1, index[1]) / 1000.0, 0, 'f', 1)
+                        .arg(grid.position(2, index[2]) / 1000.0, 0, 'f', 1));
+                }
+            }
+        }
+    }
+    scanGrid = ScanGrid();
+    scanVolumesPending = false;
+}
+
+// Takes effect from the next record; closeScanData() ends the grid. The field map of the grid is computed
+// on fieldMapThread as the records arrive.
+void PicoScope::setScanGrid(const ScanGrid& grid)
+{
+    stopScanStore();  // Records of a previous grid reach its exports and field map first
+    scanGrid = grid;
+    scanVolumesPending = !grid.empty();
+    stopFieldMap();
+    if (!grid.empty())
+    {
+        FieldMap::Settings settings;
+        settings.sensitivityMvPerMPa = fus_mainwindow->getHydrophoneSensitivityValue();
+        fieldMap.reset(grid, settings);
+        emit fieldMapReset();
+        fieldMapTimes.clear();
+        fieldMapQueue.reopen();
+        fieldMapThread = std::thread(&PicoScope::fieldMapLoop, this);
+    }
+}
+PicoScope::StreamingStats PicoScope::getStreamingStats() const
+{
+    std::lock_guard<std::mutex> lock(streamStatsMutex);
+    return streamStats;
+}
+
+void PicoScope::addStreamConsumer(const StreamConsumer& consumer)
+{
+    if (!streamRunning)
+    {
+        streamConsumers.push_back(consumer);
+    }
+}
+
+// Streams channel A continuously for lengthSeconds using ps4000RunStreaming.
+// The driver callback (CallBackStreaming) pushes every chunk into streamRing on the producer thread,
+// and the drain thread hands consecutive chunks to the plot, the stream file and any registered consumer.
+void PicoScope::streamPicoScope(unsigned int lengthSeconds)
+{
+    if (streamRunning)
+    {
+        fus_mainwindow->emitPrintSignal("Streaming already running.");
+        return;
+    }
+    if (acquisitionRunning)
+    {
+        fus_mainwindow->emitPrintSignal("Acquisition in progress, stop it before streaming.");
+        return;
+    }
+    stopStreaming();  // Joins the threads of a previous stream that ended on its own
+
+    fus_mainwindow->emitPrintSignal("Initialize streaming...");
+    SetParameters(readParameters().Timebase, 1, TRUE, 0, readParameters().Buffer);
+    applyChannels();
+    if (enabledChannelMask() != (1u << PS4000_CHANNEL_A))
+    {
+        // The stream file and consumers carry channel A only; other channels would just share its bandwidth
+        fus_mainwindow->emitPrintSignal("Streaming records channel A only.");
+        for (int channel = 0; channel < MAX_CHANNELS; channel++)
+        {
+            picoVar.unit.channelSettings[channel].enabled = channel == PS4000_CHANNEL_A ? TRUE : FALSE;
+        }
+    }
+    driver->setDefaults(&picoVar.unit);
+
+    // Streaming starts immediately, no trigger
+    struct tTriggerDirections directions;
+    struct tPwq pulseWidth;
+    memset(&directions, 0, sizeof(struct tTriggerDirections));
+    memset(&pulseWidth, 0, sizeof(struct tPwq));
+    driver->setTrigger(picoVar.unit.handle, NULL, 0, NULL, 0, &directions, &pulseWidth, 0, 0, 0);
+
+    int32_t overviewSize = readParameters().Buffer;
+    int32_t timeInterval;
+    int32_t maxSamples;
+    if (SEGMEM != 1)
+    {
+        SEGMEM = 1;  // Block reads leave the memory in two segments
+        driver->memorySegments(picoVar.unit.handle, 1, &maxSamples);
+    }
+    while (driver->getTimebase(picoVar.unit.handle, timebase, overviewSize, &timeInterval, oversample, &maxSamples, 0))
+    {
+        timebase++;
+    }
+
+    // Driver (overview) buffers for channel A: max and min
+    capturePool.invalidateRegistrations();
+    streamDriverBuffers.assign(2, nullptr);
+    streamDriverBuffers[0] = (int16_t*)malloc(overviewSize * sizeof(int16_t));
+    streamDriverBuffers[1] = (int16_t*)malloc(overviewSize * sizeof(int16_t));
+    picoVar.status_setBuffer = driver->setDataBuffers(picoVar.unit.handle, PS4000_CHANNEL_A, streamDriverBuffers[0], streamDriverBuffers[1], overviewSize);
+    fus_mainwindow->emitPrintSignal(QString::fromStdString("ps4000SetDataBuffers(channel 0) ------------" + to_string(picoVar.status_setBuffer)));
+
+    // The ring holds several overview buffers so short consumer stalls do not lose data
+    streamRing.reset((size_t)overviewSize * 8);
+
+    uint64_t wanted = (uint64_t)lengthSeconds * 1000000000ULL / (uint64_t)timeInterval;
+    uint32_t totalSamples = (uint32_t)__min(wanted, (uint64_t)UINT32_MAX);
+
+    // Default consumer: raw stream file next to the block data
+    QString dirName = "Data" + QDate::currentDate().toString("yyyyMMdd");
+    QDir dir(dirName);
+    if (!dir.exists())
+    {
+        dir.mkpath(".");
+    }
+    QString fileName = dir.absolutePath() + "/PicoStream_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".bin";
+
+    fus_mainwindow->emitPrintSignal(QString::fromStdString("Streaming " + to_string(totalSamples) + " samples at " + to_string(timeInterval) + " ns"));
+
+    {
+        std::lock_guard<std::mutex> lock(streamStatsMutex);
+        streamStats = StreamingStats();
+    }
+    replotScheduler->resetCounters();
+    shownCaptureEnd = -1;  // The first frame shows the whole capture
+    streamRunning = true;
+    streamProducerActive = true;
+    streamDrainThread = std::thread(&PicoScope::streamDrain, this, fileName, timeInterval, picoVar.unit.channelSettings[PS4000_CHANNEL_A].range);
+    streamProducerThread = std::thread(&PicoScope::streamProducer, this, totalSamples, (uint32_t)timeInterval);
+}
+
+void PicoScope::stopStreaming()
+{
+    streamRunning = false;
+    if (streamProducerThread.joinable())
+    {
+        streamProducerThread.join();
+    }
+    if (streamDrainThread.joinable())
+    {
+        streamDrainThread.join();
+    }
+    for (int16_t* buffer : streamDriverBuffers)
+    {
+        free(buffer);
+    }
+    streamDriverBuffers.clear();
+}
+
+void PicoScope::streamProducer(uint32_t totalSamples, uint32_t sampleInterval)
+{
+    RingBuffer<int16_t>* rings[PS4000_MAX_CHANNELS] = { &streamRing, NULL, NULL, NULL };
+    BUFFER_INFO bufferInfo;
+    bufferInfo.unit = &picoVar.unit;
+    bufferInfo.driverBuffers = streamDriverBuffers.data();
+    bufferInfo.appBuffers = NULL;
+    bufferInfo.ringBuffers = rings;
+    bufferInfo.overflows = 0;
+
+    g_autoStop = FALSE;
+    picoVar.status_RunBlock = driver->runStreaming(picoVar.unit.handle, &sampleInterval, PS4000_NS, 0, totalSamples, TRUE, 1, BUFFER_SIZE);
+    fus_mainwindow->emitPrintSignal(QString::fromStdString("StreamDataHandler:ps4000RunStreaming ------ " + to_string(picoVar.status_RunBlock)));
+
+    auto startTime = std::chrono::steady_clock::now();
+    if (picoVar.status_RunBlock == PICO_OK)
+    {
+        while (streamRunning && !g_autoStop)
+        {
+            g_ready = FALSE;
+            PICO_STATUS status = driver->getStreamingLatestValues(picoVar.unit.handle, CallBackStreaming, &bufferInfo);
+            if (status != PICO_OK && status != PICO_BUSY)
+            {
+                fus_mainwindow->emitPrintSignal(QString::fromStdString("StreamDataHandler:ps4000GetStreamingLatestValues ------ " + to_string(status)));
+                break;
+            }
+            if (!g_ready)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));  // Nothing new yet
+            }
+        }
+    }
+    const double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    if ((picoVar.status_Stop = driver->stop(picoVar.unit.handle)) != PICO_OK)
+    {
+        fus_mainwindow->emitPrintSignal(QString::fromStdString("StreamDataHandler:ps4000Stop ------ " + to_string(picoVar.status_Stop)));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(streamStatsMutex);
+        streamStats.elapsedSeconds = elapsedSeconds;
+        streamStats.samplesCollected = streamRing.pushed() + streamRing.dropped();
+        streamStats.samplesDropped = streamRing.dropped();
+        streamStats.overflows = bufferInfo.overflows;
+    }
+    streamProducerActive = false;
+}
+
+void PicoScope::streamDrain(QString fileName, int32_t interval_ns, int16_t range)
+{
+    // Stream file, little endian:
+    //   header  "PICOSTRM", int32 version (2), int32 sample interval in ns, int32 channel A range index
+    //   chunks  uint64 index of the first sample since the start of the stream, uint32 sample count,
+    //           then the int16 samples
+    // A chunk that does not start where the previous one ended follows samples dropped by the ring.
+    QFile file(fileName);
+    bool fileOpen = file.open(QIODevice::WriteOnly);
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    if (fileOpen)
+    {
+        out.writeRawData("PICOSTRM", 8);
+        out << qint32(2) << qint32(interval_ns) << qint32(range);
+    }
+    else
+    {
+        fus_mainwindow->emitPrintSignal("Unable to open file for writing: " + fileName);
+    }
+
+    // The plot shows the most recent Buffer samples, refreshed a few times per second
+    const size_t window = (size_t)__max(BUFFER_SIZE, 1);
+    std::vector<int16_t> recent(window);  // Circular: the oldest sample is at recentPos once full
+    size_t recentPos = 0;
+    size_t recentCount = 0;
+    auto lastPlot = std::chrono::steady_clock::now();
+
+    std::vector<int16_t> chunk(__max(streamRing.capacity() / 8, (size_t)4096));
+    uint64_t index = 0;
+    uint64_t gaps = 0;
+    while (true)
+    {
+        uint64_t firstIndex;
+        size_t n = streamRing.pop(chunk.data(), chunk.size(), firstIndex);  // Stops at a gap
+        if (n == 0)
+        {
+            if (!streamProducerActive && streamRing.available() == 0)
+            {
+                break;  // Driver finished and everything has been handed out
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        if (firstIndex != index)
+        {
+            gaps++;  // The ring dropped firstIndex - index samples here
+            index = firstIndex;
+        }
+
+        if (fileOpen)
+        {
+            out << quint64(index) << quint32(n);
+            out.writeRawData(reinterpret_cast<const char*>(chunk.data()), (int)(n * sizeof(int16_t)));  // Native little endian
+        }
+        for (const StreamConsumer& consumer : streamConsumers)
+        {
+            consumer(chunk.data(), n, index);
+        }
+
+        for (size_t i = n > window ? n - window : 0; i < n; i++)
+        {
+            recent[recentPos] = chunk[i];
+            recentPos = (recentPos + 1) % window;
+        }
+        recentCount = __min(recentCount + n, window);
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastPlot > std::chrono::milliseconds(200))
+        {
+            // Unroll the window oldest first; times are relative to the start of the plotted window
+            size_t oldest = recentCount < window ? 0 : recentPos;
+            std::vector<int16_t> ordered(recentCount);
+            for (size_t i = 0; i < recentCount; i++)
+            {
+                ordered[i] = recent[(oldest + i) % window];
+            }
+            PicoCapture capture = PicoCapture::copyOf(PS4000_CHANNEL_A, ordered.data(), (uint32_t)recentCount, 0, interval_ns, range, index);
+            spectrumAnalyzer.submit(capture);
+            std::unique_lock<std::mutex> dataLock(dataMutex);
+            picoData = std::move(capture);
+            dataLock.unlock();
+            QMetaObject::invokeMethod(this, "requestPlot", Qt::QueuedConnection);
+            lastPlot = now;
+        }
+        index += n;
+    }
+    file.close();
+
+    StreamingStats stats;
+    {
+        std::lock_guard<std::mutex> lock(streamStatsMutex);
+        streamStats.gaps = gaps;
+        stats = streamStats;
+    }
+    fus_mainwindow->emitPrintSignal(QString::fromStdString(
+        "Streaming done: " + to_string(stats.samplesCollected) + " samples in " + to_string(stats.elapsedSeconds) +
+        " s, sustained " + to_string(stats.sustainedMSps()) + " MS/s, dropped " + to_string(stats.samplesDropped) +
+        " in " + to_string(stats.gaps) + " gaps, overflows " + to_string(stats.overflows)));
+    fus_mainwindow->emitPrintSignal("Stream written to binary file: " + fileName);
+    fus_mainwindow->emitPrintSignal(QString::fromStdString("Plot: " + to_string(replotScheduler->framesDrawn()) + " frames drawn, " + to_string(replotScheduler->framesDropped()) + " dropped"));
+    streamRunning = false;
+    emit streamingFinished();
+}
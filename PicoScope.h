@@ -1,7 +1,7 @@
 // Author: Soroosh Sanatkhani
 // Columbia University
 // Created: 1 August, 2023
-// Last Modified : 26 October, 2023
+// Last Modified : 17 October, 2026
 
 #ifndef PICOSCOPE_H  // Include guard to prevent multiple inclusions
 #define PICOSCOPE_H
@@ -13,7 +13,28 @@
 #include <QFile>  // For file operations
 #include <QDataStream>  // For binary write
 #include <random>  // Includes the random library for generating random numbers
-#include <deque>  // Includes the deque library for using double-ended queues
+#include <chrono>  // For capture timeouts
+#include <atomic>  // For flags shared with the streaming threads
+#include <mutex>  // For guarding picoData while streaming
+#include <thread>  // For the streaming producer/consumer threads
+#include <functional>  // For the stream consumer callbacks
+#include <vector>
+#include "RingBuffer.h"  // Lock-free ring buffer between the streaming callback and the consumers
+#include "LatencyHistogram.h"  // For the callback wake-up latency statistics
+#include "BoundedQueue.h"  // Hand-off of finished captures to the consumers
+#include <memory>  // For sharing capture buffers between threads
+#include "CaptureBufferPool.h"  // Persistent capture buffers reused across reads
+#include "PicoCapture.h"  // Compact raw capture with time/mV computed on demand
+#include "MinMaxPyramid.h"  // Min/max level of detail for the plot
+#include "ReplotScheduler.h"  // Frame-rate cap of the plot
+#include "SpectrumAnalyzer.h"  // FFT of the captures off the GUI thread
+#include "SpectrumWaterfall.h"  // Bounded ring of spectra for the waterfall
+#include "ScanDataWriter.h"  // Background writer of the scan data file
+#include "ScanVolumeFile.h"  // NPY/MAT arrays of a gridded scan
+#include "FieldMap.h"  // Acoustic metrics per point of a gridded scan
+#include "FieldMapView.h"  // Live slice of the field map
+#include <array>
+#include "ScopeDriver.h"  // Instrument or simulated scope behind the acquisition code
 #include "Resources/qcustomplot.h"  // Includes the QCustomPlot library for plotting
 #include "windows.h"  // Includes the windows library for using Windows APIs
 #include <conio.h>  // Includes the conio library for console input/output
@@ -47,31 +68,204 @@ public:
     };
     PicoScope_Vars picoVar;
 
-    struct PicoScopeData {
-        std::deque<int64_t> t_numbers;
-        std::deque<long> MV_numbers;
+    PicoCapture picoData;  // Capture shown in the plot and written by writePicoDataToBinaryFile
+
+    // Every segment of the last rapid-block capture of the enabled channels; the segments share one contiguous block.
+    // Replaced under dataMutex from the acquisition thread.
+    std::vector<PicoCapture> rapidData;
+
+    // A capture consumer runs on the capture consumer thread for every finished capture
+    using CaptureConsumer = std::function<void(const PicoCapture& capture)>;
+
+    // Statistics of the last (or current) streaming run
+    struct StreamingStats
+    {
+        uint64_t samplesCollected = 0;  // Samples delivered by the driver
+        uint64_t samplesDropped = 0;  // Samples lost because the consumers fell behind
+        uint32_t overflows = 0;  // Callbacks reporting an over-range on the input
+        uint64_t gaps = 0;  // Places where dropped samples are missing from the chunks handed out
+        double elapsedSeconds = 0;
+        double sustainedMSps() const { return elapsedSeconds > 0 ? samplesCollected / elapsedSeconds / 1e6 : 0; }
     };
-    PicoScopeData picoData;
+
+    // A stream consumer receives the chunks of raw ADC counts of channel A in order.
+    // firstSampleIndex is the index of samples[0] since the start of the stream, counting the samples dropped
+    // when the consumers fell behind: a chunk that does not start where the previous one ended follows a gap.
+    // Consumers run on the streaming drain thread, not on the GUI thread.
+    using StreamConsumer = std::function<void(const int16_t* samples, size_t count, uint64_t firstSampleIndex)>;
 
     explicit PicoScope(FUSMainWindow* parent = nullptr);  // Constructor
     ~PicoScope();  // Destructor
 
     Parameters readParameters();  // Function to read the parameters
     PicoScope_Vars initializePicoScope();
+    void setDriver(std::unique_ptr<ScopeDriver> newDriver);  // Replaces the scope backend while the unit is closed
+    ScopeDriver* getDriver() const { return driver.get(); }
     PicoScope_Vars closePicoScope();
     void readBlockPicoScope();  // Function to read the PicoScope in block mode
-    void writePicoDataToBinaryFile(int,int,int);  // Function to write the PicoScope data to a binary file
+    void startAcquisition(int captures);  // Captures blocks on the acquisition thread; captures <= 0 runs until stopped
+    void stopAcquisition();  // Function to stop the acquisition thread and wait for it
+    bool isAcquiring() const { return acquisitionRunning; }
+    void addCaptureConsumer(const CaptureConsumer& consumer);  // Registers a consumer for the next acquisition
+    void readRapidBlockPicoScope(uint16_t nCaptures);  // Captures nCaptures triggered bursts in one arm on the acquisition thread
+    void writePicoDataToBinaryFile(int,int,int);  // Function to queue the PicoScope data for the scan data file
+    bool writeScanCapture(int x, int y, int z, const PicoCapture& capture);  // Queues a record for the scan data file and the exports; false if refused
+    size_t scanRecordsPending() const { return scanRecordsInFlight; }  // Records queued by writeScanCapture and not yet handed to the writer
+    static constexpr size_t maxScanRecordsPending = 256;  // Capacity of the hand-off; writeScanCapture waits beyond it
+    void requestScanCapture(std::chrono::steady_clock::time_point notBefore);  // Next capture read out after notBefore goes to scanCaptureReady
+    void cancelScanCapture();
+    PicoCapture currentCapture();  // The plotted capture; shares its samples
+    void flushScanData();  // Waits for the queued scan data to be written and prints the writer statistics
+    void closeScanData();  // Flushes and closes the scan data file and its NPY/MAT exports
+    void setScanGrid(const ScanGrid& grid);  // Grid of the coming scan; enables the NPY/MAT exports selected in the UI and the field map
+    const FieldMap& getFieldMap() const { return fieldMap; }  // Field map of the current or last gridded scan
+    ScanDataWriter::Stats getScanDataStats() const { return scanWriter.stats(); }
+    ScanDataFormat::FileHeader scanFileHeader(const PicoCapture& first);  // File header: the current settings and the time base of first
+    void streamPicoScope(unsigned int lengthSeconds);  // Function to stream continuously for lengthSeconds
+    void stopStreaming();  // Function to stop a running stream and wait for its threads
+    bool isStreaming() const { return streamRunning; }
+    void addStreamConsumer(const StreamConsumer& consumer);  // Registers an extra consumer for the next stream
+    StreamingStats getStreamingStats() const;  // Copy taken under streamStatsMutex
+    void setPlotFrameRate(double framesPerSecond);  // Maximum plot redraws per second
+    ReplotScheduler* getReplotScheduler() const { return replotScheduler; }
+    void setSpectrumWindow(int window);  // Index into SpectrumAnalyzer::Window
+    void clearWaterfall();  // Restarts the waterfall, e.g. when a sonication run starts
     int y_limit;
 
+signals:
+    void streamingFinished();  // Emitted from the drain thread when a stream has ended
+    void acquisitionFinished();  // Emitted from the capture consumer (or rapid block) thread when an acquisition has ended
+    void scanCaptureReady(const PicoCapture& capture);  // Emitted on the GUI thread with the capture requestScanCapture asked for
+    void fieldMapReset();  // The field map has a new grid
+    void fieldMapPointAdded(int x, int y, int z);  // Emitted from fieldMapThread once the point (um) is in the field map
+    void scanRecordStored(bool written);  // Emitted from scanStoreThread as each record is handed to the writer; false if the writer failed
+
 private slots:
-    void plotPico();  // Slot to plot the PicoScope data
+    void plotPico();  // Slot to prepare the plot of picoData, called by replotScheduler
+    void requestPlot();  // Slot to schedule a redraw with the newest picoData
+    void showLatestCapture();  // Slot to convert and plot the newest finished capture
+    void updatePlotDetail();  // Slot to re-decimate the plotted capture for the visible x range
+    void requestSpectrumPlot();  // Slot to schedule a redraw of the spectrum plot
+    void plotSpectrum();  // Slot to show the newest spectrum, called by spectrumScheduler
+    void updateSpectrumDetail();  // Slot to refill the spectrum graphs for the visible x range
 
 private:
     QCustomPlot* customPlot;  // Pointer to a QCustomPlot object
+    ReplotScheduler* replotScheduler;  // Coalesces redraw requests, owned by this object
+    PicoCapture plottedCapture;  // Capture currently on the plot; only touched on the GUI thread
+    QCPGraph* channelGraphs[PicoCapture::maxChannels];  // One graph per channel, owned by customPlot and never removed
+    std::array<MinMaxPyramid, PicoCapture::maxChannels> plotPyramids;  // Level of detail of plottedCapture per channel
+    double plotScale = 1;  // ns per x axis unit
+    bool plotRangeUpdating = false;  // Set while plotPico changes the x range itself
+    int64_t shownCaptureEnd = -1;  // End time and sample interval the x range was last fitted to
+    int32_t shownCaptureDt = -1;
+    int shownYLimit = -1;  // Y axis setting the y range was last set from
+
+    // Spectrum panel
+    QCustomPlot* spectrumPlot;
+    QCPGraph* spectrumGraphs[PicoCapture::maxChannels];
+    ReplotScheduler* spectrumScheduler;
+    SpectrumAnalyzer spectrumAnalyzer;
+    std::mutex spectrumMutex;  // Guards latestSpectrum and newSpectrum between the analyzer thread and the GUI
+    SpectrumAnalyzer::Spectrum latestSpectrum;
+    bool newSpectrum = false;
+    std::atomic<bool> spectrumPending{ false };  // A requestSpectrumPlot call is already queued
+    SpectrumAnalyzer::Spectrum shownSpectrum;  // Only touched on the GUI thread
+    double shownNyquistKHz = -1;
+    bool spectrumRangeUpdating = false;
+
+    // Waterfall panel, refreshed with the spectrum plot
+    void updateWaterfall();
+    QCustomPlot* waterfallPlot;
+    QCPColorMap* waterfallMap;  // Owned by waterfallPlot
+    SpectrumWaterfall waterfall;  // Filled on the analyzer thread
+    std::vector<float> waterfallCells;  // Copy of the ring for the GUI, reused
+    uint64_t shownWaterfallVersion = 0;
+    double shownWaterfallSpanKHz = -1;
     FUSMainWindow* fus_mainwindow;  // Pointer to a FUSMainWindow object
+    std::unique_ptr<ScopeDriver> driver;  // Every call to the scope goes through here
+
+    void applyChannels();  // Sets enable, coupling and range of channels A-D from the channel controls
+    uint32_t enabledChannelMask() const;  // Bit per channel enabled by applyChannels
+    void applyTrigger();  // Sets the channel A rising-edge trigger from TriggerVoltage_lineEdit
+    bool waitForBlockReady(std::chrono::milliseconds maxWaitTime);  // Waits for CallBackBlock to signal blockContext
+    BLOCK_CONTEXT blockContext;  // Completion context of the current block/rapid-block capture
+    LatencyHistogram callbackWakeupLatency{ "Callback wake-up latency (driver block-ready callback to acquisition thread running)" };
+
+    // Block acquisition thread
+    void configureBlock(int32_t& sampleCount, int32_t& timeInterval);  // Applies the UI settings to the unit
+    void acquisitionLoop(int captures, int32_t sampleCount, int32_t timeInterval, uint32_t channelMask);
+    void rapidBlockLoop(uint16_t nCaptures, int32_t sampleCount, uint32_t channelMask, unsigned int prf);
+    void captureConsumerLoop();
+    std::thread acquisitionThread;
+    std::thread captureConsumerThread;
+    std::atomic<bool> acquisitionRunning{ false };
+    std::atomic<bool> acquisitionStopRequested{ false };
+    int64_t segmentedSamples = 0;  // Samples over all channels the two block segments were checked for
+    BoundedQueue<PicoCapture> captureQueue{ 4 };
+    CaptureBufferPool capturePool;  // Buffers of the acquisition thread, registered with the driver across reads
+    std::vector<CaptureConsumer> captureConsumers;
+    std::mutex latestCaptureMutex;  // Guards latestCapture between the consumer thread and the GUI
+    PicoCapture latestCapture;
+    std::atomic<bool> plotPending{ false };  // A showLatestCapture call is already queued
+    void offerScanCapture(const PicoCapture& capture);  // Hands the capture to a pending requestScanCapture
+    std::mutex scanCaptureMutex;  // Guards the scan capture request between the GUI and the consumer thread
+    bool scanCaptureRequested = false;
+    std::chrono::steady_clock::time_point scanCaptureNotBefore;
+
+    // Streaming
+    void streamProducer(uint32_t totalSamples, uint32_t sampleInterval);  // Polls the driver; the callback fills streamRing
+    void streamDrain(QString fileName, int32_t interval_ns, int16_t range);  // Hands ring data to the consumers
+    std::thread streamProducerThread;
+    std::thread streamDrainThread;
+    std::atomic<bool> streamRunning{ false };  // Cleared to request the stream to stop
+    std::atomic<bool> streamProducerActive{ false };  // Cleared when the driver will deliver no more data
+    RingBuffer<int16_t> streamRing;
+    std::vector<int16_t*> streamDriverBuffers;
+    std::vector<StreamConsumer> streamConsumers;
+    StreamingStats streamStats;
+    mutable std::mutex streamStatsMutex;  // Guards streamStats between the streaming threads and its readers
+    std::mutex dataMutex;  // Guards picoData between the drain thread and plotPico
+
+    ScanDataWriter scanWriter;  // Scan data file of the session, open from the first record
+    ScanGrid scanGrid;  // Grid of the running scan, empty when the records are not gridded
+    std::filesystem::path scanBasePath;  // Scan data file name without extension, shared by the exports
+    int32_t scanIntervalNs = 0;  // Time base and record length in the open file's header; other records are refused
+    uint32_t scanSamplesPerRecord = 0;
+    ScanVolumeFile scanVolumes[2];  // NPY and MAT exports of the running scan
+    bool scanVolumesPending = false;  // Exports are created with the next record
+    void createScanVolumes(const PicoCapture& first);  // Creates the exports selected in the UI and starts scanExportThread
+    void scanExportLoop();  // Runs on scanExportThread: converts and stores the queued records in the exports
+    struct ScanExportItem
+    {
+        int x = 0;
+        int y = 0;
+        int z = 0;
+        PicoCapture capture;
+        bool exported = false;  // Goes on to scanExportQueue
+        bool mapped = false;  // Goes on to fieldMapQueue
+    };
+    void scanStoreLoop();  // Runs on scanStoreThread: writes the queued records and passes them to the exports and field map
+    void stopScanStore();  // Stores the queued records and joins scanStoreThread
+    BoundedQueue<ScanExportItem> scanStoreQueue{ maxScanRecordsPending };  // Filled from the GUI thread
+    std::thread scanStoreThread;
+    std::atomic<size_t> scanRecordsInFlight{ 0 };
+    BoundedQueue<ScanExportItem> scanExportQueue{ 64 };
+    std::thread scanExportThread;
+    LatencyHistogram scanExportTimes{ "Export per record (background)" };
+    FieldMap fieldMap;
+    FieldMapView* fieldMapView;
+    void fieldMapLoop();  // Runs on fieldMapThread: computes the metrics of the queued records into fieldMap
+    void stopFieldMap();  // Computes the queued records and joins fieldMapThread
+    BoundedQueue<ScanExportItem> fieldMapQueue{ 256 };
+    std::thread fieldMapThread;
+    LatencyHistogram fieldMapTimes{ "Field map per record (background)" };
 
 public:
     QCustomPlot* getCustomPlot() const { return customPlot; }  // Getter for the customPlot
+    QCustomPlot* getSpectrumPlot() const { return spectrumPlot; }  // Getter for the spectrum plot
+    QCustomPlot* getWaterfallPlot() const { return waterfallPlot; }  // Getter for the waterfall plot
+    FieldMapView* getFieldMapView() const { return fieldMapView; }  // Getter for the field map panel
 };
 
 #endif // PICOSCOPE_H
\ No newline at end of file
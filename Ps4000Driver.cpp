@@ -0,0 +1,108 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "Ps4000Driver.h"
+#include "Resources/ps4000.h"  // ps4000 library and the helpers in Resources/ps4000.cpp
+
+PICO_STATUS Ps4000Driver::openUnit(int16_t* handle)
+{
+    return ps4000OpenUnit(handle);
+}
+
+PICO_STATUS Ps4000Driver::closeUnit(int16_t handle)
+{
+    return ps4000CloseUnit(handle);
+}
+
+void Ps4000Driver::getInfo(UNIT_MODEL* unit)
+{
+    get_info(unit);
+}
+
+void Ps4000Driver::setDefaults(UNIT_MODEL* unit)
+{
+    SetDefaults(unit);
+}
+
+PICO_STATUS Ps4000Driver::setTrigger(int16_t handle, struct tTriggerChannelProperties* channelProperties, int16_t nChannelProperties,
+    struct tTriggerConditions* triggerConditions, int16_t nTriggerConditions, TRIGGER_DIRECTIONS* directions,
+    struct tPwq* pwq, uint32_t delay, int16_t auxOutputEnabled, int32_t autoTriggerMs)
+{
+    return SetTrigger(handle, channelProperties, nChannelProperties, triggerConditions, nTriggerConditions, directions,
+        pwq, delay, auxOutputEnabled, autoTriggerMs);
+}
+
+PICO_STATUS Ps4000Driver::getTimebase(int16_t handle, uint32_t timebase, int32_t noSamples, int32_t* timeIntervalNanoseconds,
+    int16_t oversample, int32_t* maxSamples, uint16_t segmentIndex)
+{
+    return ps4000GetTimebase(handle, timebase, noSamples, timeIntervalNanoseconds, oversample, maxSamples, segmentIndex);
+}
+
+PICO_STATUS Ps4000Driver::memorySegments(int16_t handle, uint16_t nSegments, int32_t* nMaxSamples)
+{
+    return ps4000MemorySegments(handle, nSegments, nMaxSamples);
+}
+
+PICO_STATUS Ps4000Driver::setNoOfCaptures(int16_t handle, uint16_t nCaptures)
+{
+    return ps4000SetNoOfCaptures(handle, nCaptures);
+}
+
+PICO_STATUS Ps4000Driver::getNoOfCaptures(int16_t handle, uint16_t* nCaptures)
+{
+    return ps4000GetNoOfCaptures(handle, nCaptures);
+}
+
+PICO_STATUS Ps4000Driver::setDataBuffer(int16_t handle, PS4000_CHANNEL channel, int16_t* buffer, int32_t bufferLth)
+{
+    return ps4000SetDataBuffer(handle, channel, buffer, bufferLth);
+}
+
+PICO_STATUS Ps4000Driver::setDataBuffers(int16_t handle, PS4000_CHANNEL channel, int16_t* bufferMax, int16_t* bufferMin, int32_t bufferLth)
+{
+    return ps4000SetDataBuffers(handle, channel, bufferMax, bufferMin, bufferLth);
+}
+
+PICO_STATUS Ps4000Driver::setDataBufferBulk(int16_t handle, PS4000_CHANNEL channel, int16_t* buffer, int32_t bufferLth, uint16_t waveform)
+{
+    return ps4000SetDataBufferBulk(handle, channel, buffer, bufferLth, waveform);
+}
+
+PICO_STATUS Ps4000Driver::runBlock(int16_t handle, int32_t noOfPreTriggerSamples, int32_t noOfPostTriggerSamples, uint32_t timebase,
+    int16_t oversample, int32_t* timeIndisposedMs, uint16_t segmentIndex, ps4000BlockReady lpReady, void* pParameter)
+{
+    return ps4000RunBlock(handle, noOfPreTriggerSamples, noOfPostTriggerSamples, timebase, oversample, timeIndisposedMs,
+        segmentIndex, lpReady, pParameter);
+}
+
+PICO_STATUS Ps4000Driver::getValues(int16_t handle, uint32_t startIndex, uint32_t* noOfSamples, uint32_t downSampleRatio,
+    int16_t downSampleRatioMode, uint16_t segmentIndex, int16_t* overflow)
+{
+    return ps4000GetValues(handle, startIndex, noOfSamples, downSampleRatio, downSampleRatioMode, segmentIndex, overflow);
+}
+
+PICO_STATUS Ps4000Driver::getValuesBulk(int16_t handle, uint32_t* noOfSamples, uint16_t fromSegmentIndex, uint16_t toSegmentIndex, int16_t* overflow)
+{
+    return ps4000GetValuesBulk(handle, noOfSamples, fromSegmentIndex, toSegmentIndex, overflow);
+}
+
+PICO_STATUS Ps4000Driver::runStreaming(int16_t handle, uint32_t* sampleInterval, PS4000_TIME_UNITS sampleIntervalTimeUnits,
+    uint32_t maxPreTriggerSamples, uint32_t maxPostPreTriggerSamples, int16_t autoStop, uint32_t downSampleRatio,
+    uint32_t overviewBufferSize)
+{
+    return ps4000RunStreaming(handle, sampleInterval, sampleIntervalTimeUnits, maxPreTriggerSamples, maxPostPreTriggerSamples,
+        autoStop, downSampleRatio, overviewBufferSize);
+}
+
+PICO_STATUS Ps4000Driver::getStreamingLatestValues(int16_t handle, ps4000StreamingReady lpPs4000Ready, void* pParameter)
+{
+    return ps4000GetStreamingLatestValues(handle, lpPs4000Ready, pParameter);
+}
+
+PICO_STATUS Ps4000Driver::stop(int16_t handle)
+{
+    return ps4000Stop(handle);
+}
@@ -0,0 +1,49 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef PS4000DRIVER_H  // Include guard to prevent multiple inclusions
+#define PS4000DRIVER_H
+
+#include "ScopeDriver.h"
+
+// ScopeDriver backed by the ps4000 driver library and the helpers in Resources/ps4000.cpp
+class Ps4000Driver : public ScopeDriver
+{
+public:
+    const char* name() const override { return "PicoScope 4000 (ps4000 driver)"; }
+
+    PICO_STATUS openUnit(int16_t* handle) override;
+    PICO_STATUS closeUnit(int16_t handle) override;
+    void getInfo(UNIT_MODEL* unit) override;
+    void setDefaults(UNIT_MODEL* unit) override;
+    PICO_STATUS setTrigger(int16_t handle, struct tTriggerChannelProperties* channelProperties, int16_t nChannelProperties,
+        struct tTriggerConditions* triggerConditions, int16_t nTriggerConditions, TRIGGER_DIRECTIONS* directions,
+        struct tPwq* pwq, uint32_t delay, int16_t auxOutputEnabled, int32_t autoTriggerMs) override;
+
+    PICO_STATUS getTimebase(int16_t handle, uint32_t timebase, int32_t noSamples, int32_t* timeIntervalNanoseconds,
+        int16_t oversample, int32_t* maxSamples, uint16_t segmentIndex) override;
+    PICO_STATUS memorySegments(int16_t handle, uint16_t nSegments, int32_t* nMaxSamples) override;
+    PICO_STATUS setNoOfCaptures(int16_t handle, uint16_t nCaptures) override;
+    PICO_STATUS getNoOfCaptures(int16_t handle, uint16_t* nCaptures) override;
+
+    PICO_STATUS setDataBuffer(int16_t handle, PS4000_CHANNEL channel, int16_t* buffer, int32_t bufferLth) override;
+    PICO_STATUS setDataBuffers(int16_t handle, PS4000_CHANNEL channel, int16_t* bufferMax, int16_t* bufferMin, int32_t bufferLth) override;
+    PICO_STATUS setDataBufferBulk(int16_t handle, PS4000_CHANNEL channel, int16_t* buffer, int32_t bufferLth, uint16_t waveform) override;
+
+    PICO_STATUS runBlock(int16_t handle, int32_t noOfPreTriggerSamples, int32_t noOfPostTriggerSamples, uint32_t timebase,
+        int16_t oversample, int32_t* timeIndisposedMs, uint16_t segmentIndex, ps4000BlockReady lpReady, void* pParameter) override;
+    PICO_STATUS getValues(int16_t handle, uint32_t startIndex, uint32_t* noOfSamples, uint32_t downSampleRatio,
+        int16_t downSampleRatioMode, uint16_t segmentIndex, int16_t* overflow) override;
+    PICO_STATUS getValuesBulk(int16_t handle, uint32_t* noOfSamples, uint16_t fromSegmentIndex, uint16_t toSegmentIndex, int16_t* overflow) override;
+
+    PICO_STATUS runStreaming(int16_t handle, uint32_t* sampleInterval, PS4000_TIME_UNITS sampleIntervalTimeUnits,
+        uint32_t maxPreTriggerSamples, uint32_t maxPostPreTriggerSamples, int16_t autoStop, uint32_t downSampleRatio,
+        uint32_t overviewBufferSize) override;
+    PICO_STATUS getStreamingLatestValues(int16_t handle, ps4000StreamingReady lpPs4000Ready, void* pParameter) override;
+
+    PICO_STATUS stop(int16_t handle) override;
+};
+
+#endif // PS4000DRIVER_H
@@ -0,0 +1,270 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "PulseMetrics.h"
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PULSEMETRICS_X86
+#include <immintrin.h>
+#endif
+
+// MSVC accepts AVX2 intrinsics in any function; GCC/Clang need the target enabled per function
+#if defined(PULSEMETRICS_X86) && !defined(_MSC_VER)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+namespace PulseMetrics
+{
+namespace
+{
+    void summarizeScalar(const int16_t* raw, size_t count, Summary& summary)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const int32_t sample = raw[i];
+            summary.minimum = (int16_t)(std::min)((int32_t)summary.minimum, sample);
+            summary.maximum = (int16_t)(std::max)((int32_t)summary.maximum, sample);
+            summary.sum += sample;
+            summary.sumSquares += (uint64_t)(sample * sample);
+        }
+    }
+
+#ifdef PULSEMETRICS_X86
+    // pmaddwd pairs the samples: x0 * x0 + x1 * x1 is at most 2^31, so it is read as unsigned and zero
+    // extended; x0 + x1 (pmaddwd with ones) is sign extended. Both are accumulated in 64-bit lanes.
+    TARGET_SSE2 void summarizeSSE2(const int16_t* raw, size_t count, Summary& summary)
+    {
+        const __m128i ones = _mm_set1_epi16(1);
+        const __m128i zero = _mm_setzero_si128();
+        __m128i minimum = _mm_set1_epi16(summary.minimum);
+        __m128i maximum = _mm_set1_epi16(summary.maximum);
+        __m128i sum = zero;
+        __m128i squares = zero;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+            minimum = _mm_min_epi16(minimum, v);
+            maximum = _mm_max_epi16(maximum, v);
+            const __m128i pairs = _mm_madd_epi16(v, ones);
+            const __m128i sign = _mm_srai_epi32(pairs, 31);
+            sum = _mm_add_epi64(sum, _mm_add_epi64(_mm_unpacklo_epi32(pairs, sign), _mm_unpackhi_epi32(pairs, sign)));
+            const __m128i square = _mm_madd_epi16(v, v);
+            squares = _mm_add_epi64(squares, _mm_add_epi64(_mm_unpacklo_epi32(square, zero), _mm_unpackhi_epi32(square, zero)));
+        }
+        alignas(16) int16_t lanes[8];
+        alignas(16) int64_t wide[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), minimum);
+        for (int16_t lane : lanes)
+        {
+            summary.minimum = (std::min)(summary.minimum, lane);
+        }
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), maximum);
+        for (int16_t lane : lanes)
+        {
+            summary.maximum = (std::max)(summary.maximum, lane);
+        }
+        _mm_store_si128(reinterpret_cast<__m128i*>(wide), sum);
+        summary.sum += wide[0] + wide[1];
+        _mm_store_si128(reinterpret_cast<__m128i*>(wide), squares);
+        summary.sumSquares += (uint64_t)wide[0] + (uint64_t)wide[1];
+        summarizeScalar(raw + i, count - i, summary);
+    }
+
+    TARGET_AVX2 void summarizeAVX2(const int16_t* raw, size_t count, Summary& summary)
+    {
+        const __m256i ones = _mm256_set1_epi16(1);
+        __m256i minimum = _mm256_set1_epi16(summary.minimum);
+        __m256i maximum = _mm256_set1_epi16(summary.maximum);
+        __m256i sum = _mm256_setzero_si256();
+        __m256i squares = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(raw + i));
+            minimum = _mm256_min_epi16(minimum, v);
+            maximum = _mm256_max_epi16(maximum, v);
+            const __m256i pairs = _mm256_madd_epi16(v, ones);
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+            const __m256i square = _mm256_madd_epi16(v, v);
+            squares = _mm256_add_epi64(squares, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(square)));
+            squares = _mm256_add_epi64(squares, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(square, 1)));
+        }
+        alignas(32) int16_t lanes[16];
+        alignas(32) int64_t wide[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), minimum);
+        for (int16_t lane : lanes)
+        {
+            summary.minimum = (std::min)(summary.minimum, lane);
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), maximum);
+        for (int16_t lane : lanes)
+        {
+            summary.maximum = (std::max)(summary.maximum, lane);
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(wide), sum);
+        summary.sum += wide[0] + wide[1] + wide[2] + wide[3];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(wide), squares);
+        summary.sumSquares += (uint64_t)wide[0] + (uint64_t)wide[1] + (uint64_t)wide[2] + (uint64_t)wide[3];
+        summarizeScalar(raw + i, count - i, summary);
+    }
+#endif
+
+    size_t firstOutsideScalar(const int16_t* raw, size_t begin, size_t count, int16_t low, int16_t high)
+    {
+        for (size_t i = begin; i < count; i++)
+        {
+            if (raw[i] < low || raw[i] > high)
+            {
+                return i;
+            }
+        }
+        return count;
+    }
+
+#ifdef PULSEMETRICS_X86
+    // A vector with any sample outside is located with the scalar loop
+    TARGET_SSE2 size_t firstOutsideSSE2(const int16_t* raw, size_t count, int16_t low, int16_t high)
+    {
+        const __m128i lowV = _mm_set1_epi16(low);
+        const __m128i highV = _mm_set1_epi16(high);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+            if (_mm_movemask_epi8(_mm_or_si128(_mm_cmplt_epi16(v, lowV), _mm_cmpgt_epi16(v, highV))))
+            {
+                break;
+            }
+        }
+        return firstOutsideScalar(raw, i, count, low, high);
+    }
+
+    TARGET_AVX2 size_t firstOutsideAVX2(const int16_t* raw, size_t count, int16_t low, int16_t high)
+    {
+        const __m256i lowV = _mm256_set1_epi16(low);
+        const __m256i highV = _mm256_set1_epi16(high);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(raw + i));
+            if (_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpgt_epi16(lowV, v), _mm256_cmpgt_epi16(v, highV))))
+            {
+                break;
+            }
+        }
+        return firstOutsideScalar(raw, i, count, low, high);
+    }
+#endif
+
+    // Energy about centre of a block from its sums: sum (x - c)^2 = sum x^2 - 2 c sum x + n c^2
+    double energyOf(const Summary& summary, double centre)
+    {
+        return (double)summary.sumSquares - 2 * centre * (double)summary.sum + (double)summary.count * centre * centre;
+    }
+}
+
+double Summary::rms() const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    const double m = mean();
+    return std::sqrt((std::max)(0.0, (double)sumSquares / count - m * m));
+}
+
+Summary summarize(const int16_t* raw, size_t count)
+{
+    return summarize(SampleConversion::bestKernel(), raw, count);
+}
+
+Summary summarize(SampleConversion::Kernel kernel, const int16_t* raw, size_t count)
+{
+    Summary summary;
+    if (count == 0)
+    {
+        return summary;
+    }
+    summary.count = count;
+    summary.minimum = summary.maximum = raw[0];
+    switch (kernel)
+    {
+#ifdef PULSEMETRICS_X86
+    case SampleConversion::Kernel::AVX2:
+        summarizeAVX2(raw, count, summary);
+        break;
+    case SampleConversion::Kernel::SSE2:
+        summarizeSSE2(raw, count, summary);
+        break;
+#endif
+    default:
+        summarizeScalar(raw, count, summary);
+        break;
+    }
+    return summary;
+}
+
+size_t firstOutside(const int16_t* raw, size_t count, int16_t low, int16_t high)
+{
+    return firstOutside(SampleConversion::bestKernel(), raw, count, low, high);
+}
+
+size_t firstOutside(SampleConversion::Kernel kernel, const int16_t* raw, size_t count, int16_t low, int16_t high)
+{
+    switch (kernel)
+    {
+#ifdef PULSEMETRICS_X86
+    case SampleConversion::Kernel::AVX2:
+        return firstOutsideAVX2(raw, count, low, high);
+    case SampleConversion::Kernel::SSE2:
+        return firstOutsideSSE2(raw, count, low, high);
+#endif
+    default:
+        return firstOutsideScalar(raw, 0, count, low, high);
+    }
+}
+
+void energyQuantiles(const int16_t* raw, size_t count, double centre, const double* fractions, size_t* indices, size_t n)
+{
+    const size_t blockSize = 256;
+    const SampleConversion::Kernel kernel = SampleConversion::bestKernel();
+    const double total = energyOf(summarize(kernel, raw, count), centre);
+    double energy = 0;  // Up to the start of the block
+    size_t next = 0;  // Fraction looked for
+    for (size_t begin = 0; begin < count && next < n; begin += blockSize)
+    {
+        const size_t length = (std::min)(blockSize, count - begin);
+        const double blockEnergy = energyOf(summarize(kernel, raw + begin, length), centre);
+        if (energy + blockEnergy >= fractions[next] * total)
+        {
+            for (size_t i = begin; i < begin + length && next < n; i++)
+            {
+                const double deviation = raw[i] - centre;
+                energy += deviation * deviation;
+                while (next < n && energy >= fractions[next] * total)
+                {
+                    indices[next++] = i;
+                }
+            }
+        }
+        else
+        {
+            energy += blockEnergy;
+        }
+    }
+    while (next < n)
+    {
+        indices[next++] = count ? count - 1 : 0;  // Rounding left the sum just short of the last fraction
+    }
+}
+}
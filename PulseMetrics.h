@@ -0,0 +1,42 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef PULSEMETRICS_H  // Include guard to prevent multiple inclusions
+#define PULSEMETRICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "SampleConversion.h"
+
+// Statistics of a hydrophone trace computed straight from the raw int16_t ADC counts, without converting
+// the trace first. Like SampleConversion the kernel (AVX2, SSE2 or scalar) is picked once from cpuid.
+namespace PulseMetrics
+{
+    struct Summary
+    {
+        int16_t minimum = 0;
+        int16_t maximum = 0;
+        int64_t sum = 0;
+        uint64_t sumSquares = 0;
+        size_t count = 0;
+
+        double mean() const { return count ? (double)sum / count : 0; }
+        double rms() const;  // Of the trace minus its mean, in counts
+    };
+
+    Summary summarize(const int16_t* raw, size_t count);
+    Summary summarize(SampleConversion::Kernel kernel, const int16_t* raw, size_t count);  // The kernel must be supported
+
+    // Index of the first sample below low or above high; count when there is none (e.g. the arrival of a pulse)
+    size_t firstOutside(const int16_t* raw, size_t count, int16_t low, int16_t high);
+    size_t firstOutside(SampleConversion::Kernel kernel, const int16_t* raw, size_t count, int16_t low, int16_t high);
+
+    // With E(k) the energy of the trace about centre up to sample k, sum over i <= k of (raw[i] - centre)^2:
+    // for each of the n ascending fractions the first k with E(k) >= fraction * E(count - 1). The energy is
+    // summed in blocks with summarize(), so only the blocks holding a crossing are walked sample by sample.
+    void energyQuantiles(const int16_t* raw, size_t count, double centre, const double* fractions, size_t* indices, size_t n);
+}
+
+#endif // PULSEMETRICS_H
@@ -0,0 +1,50 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "ReplotScheduler.h"
+
+ReplotScheduler::ReplotScheduler(QCustomPlot* plot, QObject* parent) : QObject(parent), plot(plot)
+{
+    frameTimer.setSingleShot(true);
+    connect(&frameTimer, &QTimer::timeout, this, &ReplotScheduler::drawFrame);
+}
+
+void ReplotScheduler::setMaxRate(double framesPerSecond)
+{
+    intervalMs = framesPerSecond > 0 ? qMax(1, qRound(1000.0 / framesPerSecond)) : 33;
+}
+
+void ReplotScheduler::requestFrame()
+{
+    if (dirty)
+    {
+        countDropped(1);  // The pending frame will show the newer data instead
+        return;
+    }
+    dirty = true;
+
+    // Draw right away if the last frame is old enough, otherwise when the interval is up
+    qint64 elapsed = sinceLastFrame.isValid() ? sinceLastFrame.elapsed() : intervalMs;
+    frameTimer.start((int)qMax<qint64>(0, intervalMs - elapsed));
+}
+
+void ReplotScheduler::resetCounters()
+{
+    drawnFrames.store(0, std::memory_order_relaxed);
+    droppedFrames.store(0, std::memory_order_relaxed);
+}
+
+void ReplotScheduler::drawFrame()
+{
+    dirty = false;
+    sinceLastFrame.start();
+    if (prepareFrame)
+    {
+        prepareFrame();
+    }
+    plot->replot(QCustomPlot::rpQueuedReplot);
+    drawnFrames.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,53 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef REPLOTSCHEDULER_H  // Include guard to prevent multiple inclusions
+#define REPLOTSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
+#include "Resources/qcustomplot.h"
+
+// Caps how often a QCustomPlot is redrawn. requestFrame() only marks the plot dirty; at most maxRate
+// times per second the frame callback prepares the newest data and a queued replot is issued
+// (QCustomPlot::rpQueuedReplot), so a burst of requests costs one frame. Requests superseded before
+// their frame was drawn are counted as dropped. Nothing here ever waits, so a slow GUI cannot hold
+// up the acquisition threads; they only see their newest data shown later.
+class ReplotScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReplotScheduler(QCustomPlot* plot, QObject* parent = nullptr);
+
+    void setFrameCallback(const std::function<void()>& callback) { prepareFrame = callback; }
+    void setMaxRate(double framesPerSecond);  // E.g. 30 Hz; takes effect from the next frame
+    double maxRate() const { return 1000.0 / intervalMs; }
+
+    void requestFrame();  // GUI thread only: newer data is ready
+    void countDropped(uint64_t frames) { droppedFrames.fetch_add(frames, std::memory_order_relaxed); }  // Any thread: data superseded before it was handed to the GUI
+
+    uint64_t framesDrawn() const { return drawnFrames.load(std::memory_order_relaxed); }
+    uint64_t framesDropped() const { return droppedFrames.load(std::memory_order_relaxed); }
+    void resetCounters();
+
+private slots:
+    void drawFrame();
+
+private:
+    QCustomPlot* plot;
+    QTimer frameTimer;
+    QElapsedTimer sinceLastFrame;
+    std::function<void()> prepareFrame;
+    int intervalMs = 33;
+    bool dirty = false;
+    std::atomic<uint64_t> drawnFrames{ 0 };
+    std::atomic<uint64_t> droppedFrames{ 0 };
+};
+
+#endif // REPLOTSCHEDULER_H
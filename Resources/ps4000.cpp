@@ -57,6 +57,7 @@
  ******************************************************************************/
 
 #include "ps4000.h"
+#include "../RingBuffer.h"
 
 int32_t BUFFER_SIZE;
 int16_t SEGMEM;
@@ -118,6 +119,11 @@ void PREF4 CallBackStreaming
         bufferInfo = (BUFFER_INFO*)pParameter;
     }
 
+    if (bufferInfo != NULL && overflow)
+    {
+        bufferInfo->overflows++;
+    }
+
     // Copy data in callback
     if (bufferInfo != NULL && noOfSamples)
     {
@@ -126,7 +132,12 @@ void PREF4 CallBackStreaming
         {
             if (bufferInfo->unit->channelSettings[channel].enabled)
             {
-                if (bufferInfo->appBuffers && bufferInfo->driverBuffers)
+                // Hand the new samples straight to the channel's ring buffer
+                if (bufferInfo->ringBuffers && bufferInfo->ringBuffers[channel] && bufferInfo->driverBuffers)
+                {
+                    bufferInfo->ringBuffers[channel]->push(&bufferInfo->driverBuffers[channel * 2][startIndex], noOfSamples);
+                }
+                else if (bufferInfo->appBuffers && bufferInfo->driverBuffers)
                 {
                     // Max buffers
                     if (bufferInfo->appBuffers[channel * 2] && bufferInfo->driverBuffers[channel * 2])
@@ -163,7 +174,8 @@ void PREF4 CallBackStreaming
 /****************************************************************************
 * Callback
 * used by ps4000 data block collection calls, on receipt of data.
-* used to set global flags etc checked by user routines
+* If pParameter is a BLOCK_CONTEXT the waiting thread is woken immediately,
+* otherwise the global flag checked by user routines is set
 ****************************************************************************/
 void PREF4 CallBackBlock
 (
@@ -172,6 +184,12 @@ void PREF4 CallBackBlock
     void* pParameter
 )
 {
+    if (pParameter != NULL)
+    {
+        ((BLOCK_CONTEXT*)pParameter)->signal(status);
+        return;
+    }
+
     // flag to say done reading data
     g_ready = TRUE;
 }
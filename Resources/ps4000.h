@@ -8,74 +8,14 @@
 #include <cstdlib>
 
 
-/* Definitions of ps4000 driver routines on Windows*/
-#include "ps4000Api.h"
-
-#define PREF4 __stdcall
-
-#define MAX_CHANNELS	4
-#define DUAL_SCOPE		2
-#define TRIPLE_SCOPE	3
-#define QUAD_SCOPE		4
+/* Definitions of ps4000 driver routines on Windows, the channel and trigger types and BLOCK_CONTEXT */
+#include "../ScopeTypes.h"
 
 // Signal generator
 #define	AWG_DAC_FREQUENCY_4000	20e6f			// 20 MS/s update rate
 #define	AWG_DAC_FREQUENCY_4262	500000.0f		// 500 kS/s update rate
 #define	AWG_PHASE_ACCUMULATOR	4294967296.0f
 
-typedef struct
-{
-    int16_t DCcoupled;
-    int16_t range;
-    int16_t enabled;
-} CHANNEL_SETTINGS;
-
-typedef enum
-{
-    MODEL_NONE = 0,
-    MODEL_PS4223 = 4223,
-    MODEL_PS4224 = 4224,
-    MODEL_PS4423 = 4423,
-    MODEL_PS4424 = 4424,
-    MODEL_PS4226 = 4226,
-    MODEL_PS4227 = 4227,
-    MODEL_PS4262 = 4262
-} MODEL_TYPE;
-
-typedef struct tTriggerDirections
-{
-    enum enThresholdDirection channelA;
-    enum enThresholdDirection channelB;
-    enum enThresholdDirection channelC;
-    enum enThresholdDirection channelD;
-    enum enThresholdDirection ext;
-    enum enThresholdDirection aux;
-} TRIGGER_DIRECTIONS;
-
-typedef struct tPwq
-{
-    struct tPwqConditions* conditions;
-    int16_t nConditions;
-    enum enThresholdDirection direction;
-    uint32_t lower;
-    uint32_t upper;
-    enum enPulseWidthType type;
-} PWQ;
-
-typedef struct
-{
-    int16_t					handle;
-    MODEL_TYPE				model;
-    PS4000_RANGE			firstRange;
-    PS4000_RANGE			lastRange;
-    uint16_t				signalGenerator;
-    uint16_t 				ETS;
-    int16_t					channelCount;
-    CHANNEL_SETTINGS		channelSettings[MAX_CHANNELS];
-    PS4000_RANGE			triggerRange;
-} UNIT_MODEL;
-
-
 extern int32_t cycles;
 extern uint32_t	timebase;
 extern int32_t BUFFER_SIZE;
@@ -93,11 +33,15 @@ extern int16_t g_trig;
 extern uint32_t g_trigAt;
 
 
+template <typename T> class RingBuffer;
+
 typedef struct tBufferInfo
 {
 	UNIT_MODEL* unit;
 	int16_t** driverBuffers;
 	int16_t** appBuffers;
+	RingBuffer<int16_t>** ringBuffers;	// Optional per-channel rings fed directly from the driver buffers
+	uint32_t overflows;					// Number of callbacks that reported an over-range
 } BUFFER_INFO;
 
 void PREF4 CallBackStreaming
@@ -0,0 +1,175 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef RINGBUFFER_H  // Include guard to prevent multiple inclusions
+#define RINGBUFFER_H
+
+#include <atomic>  // For the lock-free read/write indices
+#include <vector>  // Storage of the ring
+#include <cstdint>
+#include <cstring>  // For memcpy
+#include <algorithm>  // For std::min
+
+// Single-producer / single-consumer lock-free ring buffer.
+// The producer (e.g. the ps4000 streaming callback) calls push() and the consumer
+// (e.g. the thread handing samples to plot/writer/analysis) calls pop(); no locks are taken.
+// Samples that do not fit when the ring is full are dropped and counted in dropped(). Each drop is also
+// recorded with its position, so pop() with firstIndex stops at a gap and numbers the elements by their
+// position in the producer's stream, lost elements included.
+template <typename T>
+class RingBuffer
+{
+public:
+    explicit RingBuffer(size_t capacity = 0)
+    {
+        reset(capacity);
+    }
+
+    // Resizes and empties the ring. Not thread safe: only call while no producer/consumer is active.
+    void reset(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;  // Round up to a power of two so indices wrap with a mask
+        }
+        buffer.assign(capacity ? size : 0, T());
+        mask = capacity ? size - 1 : 0;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        droppedCount.store(0, std::memory_order_relaxed);
+        pushedCount.store(0, std::memory_order_relaxed);
+        gapHead.store(0, std::memory_order_relaxed);
+        gapTail.store(0, std::memory_order_relaxed);
+        pendingLost = 0;
+        lostBeforeTail = 0;
+    }
+
+    size_t capacity() const { return buffer.size(); }
+
+    // Number of elements ready to be popped
+    size_t available() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    // Producer side: copies up to count elements in, returns the number actually written
+    size_t push(const T* data, size_t count)
+    {
+        const size_t w = head.load(std::memory_order_relaxed);
+        const size_t r = tail.load(std::memory_order_acquire);
+        const size_t space = buffer.size() - (w - r);
+        size_t n = (std::min)(count, space);
+
+        // A drop not recorded yet (the gap list was full) goes in before any new element
+        if (pendingLost && !recordGap(w))
+        {
+            n = 0;
+        }
+        if (n < count)
+        {
+            droppedCount.fetch_add(count - n, std::memory_order_relaxed);
+            pendingLost += count - n;
+            recordGap(w + n);
+        }
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        const size_t start = w & mask;
+        const size_t first = (std::min)(n, buffer.size() - start);
+        memcpy(&buffer[start], data, first * sizeof(T));
+        memcpy(&buffer[0], data + first, (n - first) * sizeof(T));
+
+        head.store(w + n, std::memory_order_release);
+        pushedCount.fetch_add(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    // Consumer side: as pop(), but stops at the next gap; firstIndex receives the stream position of data[0]
+    size_t pop(T* data, size_t count, uint64_t& firstIndex)
+    {
+        // The write index is read first: a gap recorded after it lies beyond the elements it makes available
+        const size_t r = tail.load(std::memory_order_relaxed);
+        const size_t w = head.load(std::memory_order_acquire);
+        size_t g = gapTail.load(std::memory_order_relaxed);
+        size_t limit = (std::min)(count, w - r);
+        while (g != gapHead.load(std::memory_order_acquire))
+        {
+            const Gap& gap = gaps[g % maxGaps];
+            if (gap.position > r)
+            {
+                limit = (std::min)(limit, (size_t)(gap.position - r));
+                break;
+            }
+            lostBeforeTail += gap.lost;  // The gap is before the next element
+            gapTail.store(++g, std::memory_order_release);
+        }
+        firstIndex = r + lostBeforeTail;
+        return pop(data, limit);
+    }
+
+    // Consumer side: copies up to count elements out, returns the number actually read
+    size_t pop(T* data, size_t count)
+    {
+        const size_t r = tail.load(std::memory_order_relaxed);
+        const size_t w = head.load(std::memory_order_acquire);
+        const size_t n = (std::min)(count, w - r);
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        const size_t start = r & mask;
+        const size_t first = (std::min)(n, buffer.size() - start);
+        memcpy(data, &buffer[start], first * sizeof(T));
+        memcpy(data + first, &buffer[0], (n - first) * sizeof(T));
+
+        tail.store(r + n, std::memory_order_release);
+        return n;
+    }
+
+    uint64_t pushed() const { return pushedCount.load(std::memory_order_relaxed); }  // Total elements accepted
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }  // Total elements lost to a full ring
+
+private:
+    std::vector<T> buffer;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> head{ 0 };  // Write index, owned by the producer
+    alignas(64) std::atomic<size_t> tail{ 0 };  // Read index, owned by the consumer
+    alignas(64) std::atomic<uint64_t> droppedCount{ 0 };
+    std::atomic<uint64_t> pushedCount{ 0 };
+
+    // Drops in order of position; written by the producer, released by the consumer once passed
+    struct Gap
+    {
+        uint64_t position = 0;  // Write index of the first element after the gap
+        uint64_t lost = 0;
+    };
+    static constexpr size_t maxGaps = 64;
+
+    // Producer side: publishes pendingLost as a gap at position; false if the list is full
+    bool recordGap(size_t position)
+    {
+        const size_t g = gapHead.load(std::memory_order_relaxed);
+        if (g - gapTail.load(std::memory_order_acquire) == maxGaps)
+        {
+            return false;  // The consumer has not read up to the oldest gap yet
+        }
+        gaps[g % maxGaps] = { position, pendingLost };
+        gapHead.store(g + 1, std::memory_order_release);
+        pendingLost = 0;
+        return true;
+    }
+
+    Gap gaps[maxGaps];
+    alignas(64) std::atomic<size_t> gapHead{ 0 };  // Owned by the producer
+    uint64_t pendingLost = 0;  // Owned by the producer: dropped but not in gaps yet
+    alignas(64) std::atomic<size_t> gapTail{ 0 };  // Owned by the consumer
+    uint64_t lostBeforeTail = 0;  // Owned by the consumer: dropped before the read index
+};
+
+#endif // RINGBUFFER_H
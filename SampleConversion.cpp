@@ -0,0 +1,324 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "SampleConversion.h"
+#include <chrono>
+#include <new>
+#include <random>
+#include <sstream>
+#include <iomanip>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SAMPLECONVERSION_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// MSVC accepts AVX2 intrinsics in any function; GCC/Clang need the target enabled per function
+#if defined(SAMPLECONVERSION_X86) && !defined(_MSC_VER)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+namespace SampleConversion
+{
+namespace
+{
+    template <typename T>
+    void scaleScalar(const int16_t* raw, T* out, size_t count, T factor)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = raw[i] * factor;
+        }
+    }
+
+#ifdef SAMPLECONVERSION_X86
+    void cpuid(int leaf, int subleaf, int info[4])
+    {
+#if defined(_MSC_VER)
+        __cpuidex(info, leaf, subleaf);
+#else
+        unsigned int a = 0, b = 0, c = 0, d = 0;
+        __get_cpuid_count(leaf, subleaf, &a, &b, &c, &d);
+        info[0] = (int)a; info[1] = (int)b; info[2] = (int)c; info[3] = (int)d;
+#endif
+    }
+
+    uint64_t xgetbv0()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return ((uint64_t)hi << 32) | lo;
+#endif
+    }
+
+    Kernel detectKernel()
+    {
+        int info[4];
+        cpuid(0, 0, info);
+        const int maxLeaf = info[0];
+        cpuid(1, 0, info);
+        const bool sse2 = (info[3] & (1 << 26)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        bool avx2 = false;
+        if (maxLeaf >= 7 && osxsave && avx && (xgetbv0() & 0x6) == 0x6)  // OS saves the XMM and YMM state
+        {
+            cpuid(7, 0, info);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+        return avx2 ? Kernel::AVX2 : (sse2 ? Kernel::SSE2 : Kernel::Scalar);
+    }
+
+    // 8 samples per iteration: sign-extend int16 to int32 by unpacking and shifting, convert, multiply
+    TARGET_SSE2 void scaleSSE2(const int16_t* raw, float* out, size_t count, float factor)
+    {
+        const __m128 f = _mm_set1_ps(factor);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), f));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), f));
+        }
+        scaleScalar(raw + i, out + i, count - i, factor);
+    }
+
+    TARGET_SSE2 void scaleSSE2(const int16_t* raw, double* out, size_t count, double factor)
+    {
+        const __m128d f = _mm_set1_pd(factor);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_pd(out + i, _mm_mul_pd(_mm_cvtepi32_pd(lo), f));
+            _mm_storeu_pd(out + i + 2, _mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2))), f));
+            _mm_storeu_pd(out + i + 4, _mm_mul_pd(_mm_cvtepi32_pd(hi), f));
+            _mm_storeu_pd(out + i + 6, _mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2))), f));
+        }
+        scaleScalar(raw + i, out + i, count - i, factor);
+    }
+
+    // 16 samples per iteration with vpmovsxwd doing the sign extension
+    TARGET_AVX2 void scaleAVX2(const int16_t* raw, float* out, size_t count, float factor)
+    {
+        const __m256 f = _mm256_set1_ps(factor);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256i a = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i)));
+            __m256i b = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i + 8)));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(a), f));
+            _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), f));
+        }
+        scaleScalar(raw + i, out + i, count - i, factor);
+    }
+
+    TARGET_AVX2 void scaleAVX2(const int16_t* raw, double* out, size_t count, double factor)
+    {
+        const __m256d f = _mm256_set1_pd(factor);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+            __m128i lo = _mm_cvtepi16_epi32(v);
+            __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(v, 8));
+            _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_cvtepi32_pd(lo), f));
+            _mm256_storeu_pd(out + i + 4, _mm256_mul_pd(_mm256_cvtepi32_pd(hi), f));
+        }
+        scaleScalar(raw + i, out + i, count - i, factor);
+    }
+#else
+    Kernel detectKernel()
+    {
+        return Kernel::Scalar;
+    }
+#endif
+
+    template <typename T>
+    void scaleWith(Kernel kernel, const int16_t* raw, T* out, size_t count, T factor)
+    {
+        switch (kernel)
+        {
+#ifdef SAMPLECONVERSION_X86
+        case Kernel::AVX2:
+            scaleAVX2(raw, out, count, factor);
+            return;
+        case Kernel::SSE2:
+            scaleSSE2(raw, out, count, factor);
+            return;
+#endif
+        default:
+            scaleScalar(raw, out, count, factor);
+            return;
+        }
+    }
+
+    std::string benchmarkLine(Kernel kernel, const char* type, size_t count, double seconds, double scalarSeconds, bool correct)
+    {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(2) << type << " " << std::left << std::setw(6) << kernelName(kernel) << std::right
+             << std::setw(7) << count / 1e6 << " M samples: " << std::setw(8) << seconds * 1e3 << " ms, "
+             << std::setw(8) << std::setprecision(0) << count / seconds / 1e6 << " MS/s";
+        if (scalarSeconds > 0)
+        {
+            line << std::setprecision(2) << ", x" << scalarSeconds / seconds << " vs scalar";
+        }
+        if (!correct)
+        {
+            line << "  MISMATCH";
+        }
+        return line.str();
+    }
+
+    template <typename T>
+    void benchmarkType(const char* type, const std::vector<int16_t>& raw, std::vector<std::string>& report)
+    {
+        const size_t count = raw.size();
+        const T factor = (T)(1000.0 / 32764.0);  // 1 V range
+        const int repeats = (int)__max((size_t)1, (size_t)20000000 / count);
+        std::vector<T> out;
+        try
+        {
+            out.assign(count, T(0));  // Also faults in every page before timing
+        }
+        catch (const std::bad_alloc&)
+        {
+            report.push_back(std::string(type) + ": not enough memory for " + std::to_string(count) + " samples, skipped");
+            return;
+        }
+
+        double scalarSeconds = 0;
+        for (Kernel kernel : { Kernel::Scalar, Kernel::SSE2, Kernel::AVX2 })
+        {
+            if (!isSupported(kernel))
+            {
+                continue;
+            }
+            double best = 1e30;
+            for (int repeat = 0; repeat < repeats; repeat++)
+            {
+                auto start = std::chrono::steady_clock::now();
+                scale(kernel, raw.data(), out.data(), count, factor);
+                best = __min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            }
+            bool correct = true;
+            for (size_t i = 0; i < count; i += 997)
+            {
+                correct = correct && out[i] == raw[i] * factor;
+            }
+            correct = correct && out[count - 1] == raw[count - 1] * factor;
+            if (kernel == Kernel::Scalar)
+            {
+                scalarSeconds = best;
+            }
+            report.push_back(benchmarkLine(kernel, type, count, best, kernel == Kernel::Scalar ? 0 : scalarSeconds, correct));
+        }
+    }
+}
+
+Kernel bestKernel()
+{
+    static const Kernel kernel = detectKernel();
+    return kernel;
+}
+
+bool isSupported(Kernel kernel)
+{
+    return (int)kernel <= (int)bestKernel();
+}
+
+const char* kernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Kernel::AVX2:
+        return "AVX2";
+    case Kernel::SSE2:
+        return "SSE2";
+    default:
+        return "scalar";
+    }
+}
+
+void scale(Kernel kernel, const int16_t* raw, float* out, size_t count, float factor)
+{
+    scaleWith(kernel, raw, out, count, factor);
+}
+
+void scale(Kernel kernel, const int16_t* raw, double* out, size_t count, double factor)
+{
+    scaleWith(kernel, raw, out, count, factor);
+}
+
+void toMillivolts(const int16_t* raw, float* mv, size_t count, double mvPerCount)
+{
+    scaleWith(bestKernel(), raw, mv, count, (float)mvPerCount);
+}
+
+void toMillivolts(const int16_t* raw, double* mv, size_t count, double mvPerCount)
+{
+    scaleWith(bestKernel(), raw, mv, count, mvPerCount);
+}
+
+void toPascals(const int16_t* raw, float* pa, size_t count, double mvPerCount, double sensitivityMvPerPa)
+{
+    scaleWith(bestKernel(), raw, pa, count, (float)(mvPerCount / sensitivityMvPerPa));
+}
+
+void toPascals(const int16_t* raw, double* pa, size_t count, double mvPerCount, double sensitivityMvPerPa)
+{
+    scaleWith(bestKernel(), raw, pa, count, mvPerCount / sensitivityMvPerPa);
+}
+
+std::vector<std::string> benchmark(const std::vector<size_t>& sampleCounts)
+{
+    std::vector<std::string> report;
+    report.push_back(std::string("Sample conversion benchmark, best kernel on this CPU: ") + kernelName(bestKernel()));
+
+    std::mt19937 generator(12345);
+    std::uniform_int_distribution<int> distribution(INT16_MIN, INT16_MAX);
+    for (size_t count : sampleCounts)
+    {
+        if (count == 0)
+        {
+            continue;
+        }
+        std::vector<int16_t> raw;
+        try
+        {
+            raw.resize(count);
+        }
+        catch (const std::bad_alloc&)
+        {
+            report.push_back("Not enough memory for " + std::to_string(count) + " samples, skipped");
+            continue;
+        }
+        for (int16_t& sample : raw)
+        {
+            sample = (int16_t)distribution(generator);
+        }
+        benchmarkType<float>("float ", raw, report);
+        benchmarkType<double>("double", raw, report);
+    }
+    return report;
+}
+}
@@ -0,0 +1,47 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SAMPLECONVERSION_H  // Include guard to prevent multiple inclusions
+#define SAMPLECONVERSION_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Batch conversion of raw int16_t ADC counts to millivolts or pascals.
+// Every conversion is out[i] = raw[i] * factor, done with AVX2 or SSE2 when the CPU supports it and
+// with a scalar loop otherwise. The kernel is picked once at runtime from cpuid.
+namespace SampleConversion
+{
+    enum class Kernel
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    Kernel bestKernel();  // Fastest kernel supported by this CPU and OS
+    bool isSupported(Kernel kernel);
+    const char* kernelName(Kernel kernel);
+
+    // mvPerCount is the full-scale range in mV divided by the maximum ADC count (see PicoCapture::mvPerCount)
+    void toMillivolts(const int16_t* raw, float* mv, size_t count, double mvPerCount);
+    void toMillivolts(const int16_t* raw, double* mv, size_t count, double mvPerCount);
+
+    // sensitivityMvPerPa is the hydrophone (plus amplifier) sensitivity in mV/Pa
+    void toPascals(const int16_t* raw, float* pa, size_t count, double mvPerCount, double sensitivityMvPerPa);
+    void toPascals(const int16_t* raw, double* pa, size_t count, double mvPerCount, double sensitivityMvPerPa);
+
+    // out[i] = raw[i] * factor with a given kernel; the kernel must be supported
+    void scale(Kernel kernel, const int16_t* raw, float* out, size_t count, float factor);
+    void scale(Kernel kernel, const int16_t* raw, double* out, size_t count, double factor);
+
+    // Times every supported kernel on sampleCounts random samples (float and double output) and
+    // returns one report line per kernel and size with MS/s and the speed-up over the scalar loop
+    std::vector<std::string> benchmark(const std::vector<size_t>& sampleCounts = { 1000000, 10000000, 100000000 });
+}
+
+#endif // SAMPLECONVERSION_H
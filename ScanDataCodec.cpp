@@ -0,0 +1,112 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+// Built without the precompiled header so that ScanDataTool can share it without Qt
+#include "ScanDataCodec.h"
+#include <cstring>
+
+namespace ScanDataCodec
+{
+    const char* name(uint8_t codec)
+    {
+        switch (codec)
+        {
+        case Raw: return "raw";
+        case DeltaBitPack: return "delta + bit packing";
+        default: return "unknown";
+        }
+    }
+
+    // Deltas of int16_t samples span 17 bits; zigzag maps them to 0, 1, 2, ... for 0, -1, 1, ...
+    static inline uint32_t zigzag(int32_t delta)
+    {
+        return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    }
+
+    static inline int32_t unzigzag(uint32_t value)
+    {
+        return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+    }
+
+    size_t encode(const int16_t* samples, size_t count, uint8_t* out)
+    {
+        uint8_t* start = out;
+        int32_t previous = 0;
+        uint32_t values[blockSamples];
+        for (size_t first = 0; first < count; first += blockSamples)
+        {
+            const size_t n = count - first < blockSamples ? count - first : blockSamples;
+            uint32_t any = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                const int32_t sample = samples[first + i];
+                values[i] = zigzag(sample - previous);
+                previous = sample;
+                any |= values[i];
+            }
+            int bits = 0;
+            while (any >> bits)
+            {
+                bits++;
+            }
+
+            *out++ = (uint8_t)bits;
+            uint64_t accumulator = 0;
+            int filled = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                accumulator |= (uint64_t)values[i] << filled;
+                filled += bits;
+                while (filled >= 8)
+                {
+                    *out++ = (uint8_t)accumulator;
+                    accumulator >>= 8;
+                    filled -= 8;
+                }
+            }
+            if (filled > 0)
+            {
+                *out++ = (uint8_t)accumulator;
+            }
+        }
+        return out - start;
+    }
+
+    bool decode(const uint8_t* in, size_t inBytes, int16_t* samples, size_t count)
+    {
+        const uint8_t* end = in + inBytes;
+        int32_t previous = 0;
+        for (size_t first = 0; first < count; first += blockSamples)
+        {
+            const size_t n = count - first < blockSamples ? count - first : blockSamples;
+            if (in >= end)
+            {
+                return false;
+            }
+            const int bits = *in++;
+            const size_t bytes = (n * bits + 7) / 8;
+            if (bits > 17 || (size_t)(end - in) < bytes)
+            {
+                return false;
+            }
+            const uint32_t mask = (1u << bits) - 1;
+            uint64_t accumulator = 0;
+            int filled = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                while (filled < bits)
+                {
+                    accumulator |= (uint64_t)*in++ << filled;
+                    filled += 8;
+                }
+                previous += unzigzag((uint32_t)accumulator & mask);
+                accumulator >>= bits;
+                filled -= bits;
+                samples[first + i] = (int16_t)previous;
+            }
+        }
+        return in == end;
+    }
+}
@@ -0,0 +1,189 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SCANDATAFORMAT_H  // Include guard to prevent multiple inclusions
+#define SCANDATAFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+// On-disk layout of scan data files (.bin), all values little endian:
+//
+//   FileHeader                         fixed size, once at the start
+//   RecordHeader, samples              once per capture
+//   RecordHeader, samples
+//   ...
+//   IndexHeader, IndexEntry[]          once at the end, written when the file is closed
+//
+// The samples of a record are the raw int16_t ADC counts, channel-major: all samples of the lowest
+// channel present, then the next, for every bit set in the record's channelMask. A record whose codec
+// is not ScanDataCodec::Raw instead holds per channel (same order) a uint32_t byte count followed by
+// that many bytes of the channel encoded with ScanDataCodec. Millivolts are
+// counts * rangeMillivolts[range] / maxAdcValue (copies of inputRanges and PS4000_MAX_VALUE of ps4000.h),
+// times are t0Ns + i * intervalNs. The trailing index lists the position, offset and size of every
+// record; FileHeader.indexOffset points to it and stays 0 in a file that was never closed (the records
+// are then found by walking the record headers). Every header carries its own size, so a reader skips fields added
+// by later versions; a new version only appends fields and never moves existing ones.
+namespace ScanDataFormat
+{
+    constexpr char fileMagic[8] = { 'F', 'U', 'S', 'S', 'C', 'A', 'N', '\0' };
+    constexpr uint32_t recordMagic = 0x31434552;  // "REC1"
+    constexpr char indexMagic[8] = { 'F', 'U', 'S', 'I', 'N', 'D', 'E', 'X' };
+    constexpr uint16_t version = 2;  // 2: records may be compressed
+    constexpr int maxChannels = 4;
+
+    enum TriggerDirection : int16_t
+    {
+        Rising = 0,
+        Falling = 1
+    };
+
+#pragma pack(push, 1)
+    struct FileHeader
+    {
+        char magic[8];
+        uint16_t version;
+        uint16_t fileHeaderBytes;  // sizeof(FileHeader) of the writer
+        uint16_t recordHeaderBytes;  // sizeof(RecordHeader) of the writer
+        uint16_t reserved0;
+        int64_t createdUnixMs;
+
+        // Device
+        char deviceModel[24];  // NUL terminated, e.g. "PS4424"
+        int16_t maxAdcValue;  // ADC counts at full scale
+        int16_t reserved1;
+        uint32_t timebase;
+        int32_t intervalNs;  // Of the first record; every record carries its own
+        uint32_t samplesPerRecord;  // Of the first record; every record carries its own
+        uint16_t channelMask;  // Bit per channel A-D enabled
+        int16_t range[maxChannels];  // PS4000_RANGE per channel
+        int16_t dcCoupled[maxChannels];
+
+        // Trigger
+        int16_t triggerEnabled;
+        int16_t triggerChannel;
+        int16_t triggerDirection;  // TriggerDirection
+        int16_t reserved2;
+        int32_t triggerThresholdMv;
+        int32_t triggerDelaySamples;
+
+        // Waveform generator (as entered in the GUI)
+        int32_t waveformFrequencyHz;
+        int32_t waveformAmplitudeMv;  // Peak to peak
+        int32_t waveformPulseDurationMs;
+        int32_t waveformDutyCycle;  // %
+        int32_t waveformPrfHz;
+        int32_t waveformLengthS;
+
+        // Trailing index, filled in when the file is closed
+        uint64_t indexOffset;  // 0 if the file has no index
+        uint64_t recordCount;
+
+        // Full scale in mV of every PS4000_RANGE, so millivolts need nothing but the file
+        uint16_t rangeMillivolts[16];
+
+        uint16_t recordCodec;  // ScanDataCodec the writer used; records that would not shrink are still Raw
+
+        uint8_t reserved[84];  // Zero; room for later fields
+    };
+
+    struct RecordHeader
+    {
+        uint32_t magic;  // recordMagic
+        uint32_t recordBytes;  // This header plus the samples
+        uint64_t recordIndex;  // 0, 1, ... in file order
+        int32_t x;  // Stage position in um from the gantry origin
+        int32_t y;
+        int32_t z;
+        uint32_t sampleCount;  // Per channel
+        int64_t timestampUnixNs;  // When the record was queued
+        int64_t t0Ns;  // Time of the first sample relative to the trigger
+        int32_t intervalNs;
+        uint16_t channelMask;
+        int16_t range[maxChannels];  // PS4000_RANGE per channel, 0 for absent channels
+        uint8_t codec;  // ScanDataCodec::Codec of the samples
+        uint8_t reserved;
+    };
+
+    struct IndexHeader
+    {
+        char magic[8];  // indexMagic
+        uint64_t entryCount;
+        uint32_t entryBytes;  // sizeof(IndexEntry) of the writer
+        uint32_t reserved;
+    };
+
+    struct IndexEntry
+    {
+        int32_t x;
+        int32_t y;
+        int32_t z;
+        uint32_t recordBytes;  // Header plus samples
+        uint64_t offset;  // Of the RecordHeader from the start of the file
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(FileHeader) == 256, "FileHeader must stay 256 bytes");
+    static_assert(sizeof(RecordHeader) == 64, "RecordHeader must stay 64 bytes");
+    static_assert(sizeof(IndexHeader) == 24, "IndexHeader must stay 24 bytes");
+    static_assert(sizeof(IndexEntry) == 24, "IndexEntry must stay 24 bytes");
+
+    inline int channelCount(uint32_t channelMask)
+    {
+        int n = 0;
+        for (int channel = 0; channel < maxChannels; channel++)
+        {
+            n += (channelMask >> channel) & 1;
+        }
+        return n;
+    }
+
+    // Position of a channel's samples among the blocks of a record (the number of lower channels present)
+    inline int channelBlock(uint32_t channelMask, int channel)
+    {
+        return channelCount(channelMask & ((1u << channel) - 1));
+    }
+
+    // Size of the decoded samples
+    inline uint64_t sampleBytes(const RecordHeader& header)
+    {
+        return (uint64_t)header.sampleCount * channelCount(header.channelMask) * sizeof(int16_t);
+    }
+
+    inline double mvPerCount(const FileHeader& header, int16_t range)
+    {
+        const bool known = range >= 0 && range < 16 && header.maxAdcValue > 0;
+        return known ? header.rangeMillivolts[range] / (double)header.maxAdcValue : 0;
+    }
+
+    inline FileHeader makeFileHeader()
+    {
+        FileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, fileMagic, sizeof(fileMagic));
+        header.version = version;
+        header.fileHeaderBytes = sizeof(FileHeader);
+        header.recordHeaderBytes = sizeof(RecordHeader);
+        return header;
+    }
+
+    inline bool isValid(const FileHeader& header)
+    {
+        return memcmp(header.magic, fileMagic, sizeof(fileMagic)) == 0 && header.version >= 1 &&
+            header.fileHeaderBytes >= sizeof(FileHeader) && header.recordHeaderBytes >= sizeof(RecordHeader);
+    }
+
+    inline bool isValid(const RecordHeader& header)
+    {
+        return header.magic == recordMagic && header.recordBytes >= sizeof(RecordHeader);
+    }
+
+    inline bool isValid(const IndexHeader& header)
+    {
+        return memcmp(header.magic, indexMagic, sizeof(indexMagic)) == 0 && header.entryBytes >= sizeof(IndexEntry);
+    }
+}
+
+#endif // SCANDATAFORMAT_H
@@ -0,0 +1,232 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+// Built without the precompiled header so that ScanDataTool can share it without Qt
+#include "ScanDataReader.h"
+#include <cstring>
+#include "ScanDataCodec.h"
+
+std::span<const int16_t> ScanDataReader::RecordView::channel(int channel) const
+{
+    if (!samples || !hasChannel(channel))
+    {
+        return {};
+    }
+    const size_t block = ScanDataFormat::channelBlock(header.channelMask, channel);
+    return std::span<const int16_t>(samples + block * header.sampleCount, header.sampleCount);
+}
+
+std::span<const int16_t> ScanDataReader::Record::channel(int channel) const
+{
+    if (!hasChannel(channel))
+    {
+        return {};
+    }
+    const size_t block = ScanDataFormat::channelBlock(header.channelMask, channel);
+    return std::span<const int16_t>(samples.data() + block * header.sampleCount, header.sampleCount);
+}
+
+bool ScanDataReader::open(const std::filesystem::path& path)
+{
+    close();
+    filePath = path;
+    if (!file.open(path))
+    {
+        return fail(file.lastError());
+    }
+    if (file.size() < sizeof(fileHeader))
+    {
+        file.close();
+        return fail(path.string() + " is not a scan data file");
+    }
+    memcpy(&fileHeader, file.data(), sizeof(fileHeader));
+    if (!ScanDataFormat::isValid(fileHeader))
+    {
+        file.close();
+        return fail(path.string() + " is not a scan data file");
+    }
+
+    fromIndex = fileHeader.indexOffset != 0 && loadIndex();
+    if (!fromIndex)
+    {
+        rebuildIndex();
+    }
+
+    positions.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        positions[{ entries[i].x, entries[i].y, entries[i].z }] = i;
+    }
+    return true;
+}
+
+void ScanDataReader::close()
+{
+    file.close();
+    fileHeader = {};
+    entries.clear();
+    positions.clear();
+    fromIndex = false;
+    error.clear();
+}
+
+int64_t ScanDataReader::find(const Position& position) const
+{
+    auto it = positions.find(position);
+    return it == positions.end() ? -1 : (int64_t)it->second;
+}
+
+ScanDataReader::RecordView ScanDataReader::record(size_t record) const
+{
+    RecordView view;
+    if (record >= entries.size())
+    {
+        return view;
+    }
+    const ScanDataFormat::IndexEntry& entry = entries[record];
+    if (entry.offset + sizeof(view.header) > file.size() || entry.offset + entry.recordBytes > file.size())
+    {
+        return view;
+    }
+    memcpy(&view.header, file.data() + entry.offset, sizeof(view.header));
+    if (!ScanDataFormat::isValid(view.header) || view.header.recordBytes != entry.recordBytes)
+    {
+        return view;
+    }
+    const uint8_t* begin = file.data() + entry.offset + sizeof(view.header);
+    const uint64_t payload = view.header.recordBytes - sizeof(view.header);
+    if (view.header.codec != ScanDataCodec::Raw)
+    {
+        view.encoded = begin;
+        view.encodedBytes = payload;
+        return view;
+    }
+    const uint64_t bytes = ScanDataFormat::sampleBytes(view.header);
+    if (bytes > payload)
+    {
+        return view;
+    }
+    // The samples end the record; anything a later version appends to the header comes before them.
+    // Records start at even offsets, so the samples are aligned for int16_t.
+    view.samples = (const int16_t*)(begin + payload - bytes);
+    return view;
+}
+
+ScanDataReader::RecordView ScanDataReader::record(const Position& position) const
+{
+    const int64_t index = find(position);
+    return index < 0 ? RecordView() : record((size_t)index);
+}
+
+bool ScanDataReader::readRecord(size_t record, Record& out)
+{
+    const RecordView view = this->record(record);
+    if (record >= entries.size())
+    {
+        return fail("Record " + std::to_string(record) + " out of range");
+    }
+    const int16_t* samples = decode(view, out.samples);
+    if (!samples)
+    {
+        return fail("Corrupt record " + std::to_string(record) + " in " + filePath.string());
+    }
+    out.header = view.header;
+    if (samples != out.samples.data())
+    {
+        out.samples.assign(samples, samples + ScanDataFormat::sampleBytes(view.header) / sizeof(int16_t));
+    }
+    return true;
+}
+
+const int16_t* ScanDataReader::decode(const RecordView& record, std::vector<int16_t>& scratch) const
+{
+    if (record.samples || !record.compressed())
+    {
+        return record.samples;
+    }
+    if (record.header.codec != ScanDataCodec::DeltaBitPack)
+    {
+        return nullptr;
+    }
+    const uint32_t count = record.header.sampleCount;
+    scratch.resize(ScanDataFormat::sampleBytes(record.header) / sizeof(int16_t));
+    const uint8_t* in = record.encoded;
+    const uint8_t* end = record.encoded + record.encodedBytes;
+    const int channels = ScanDataFormat::channelCount(record.header.channelMask);
+    for (int k = 0; k < channels; k++)
+    {
+        uint32_t bytes;
+        if (end - in < (ptrdiff_t)sizeof(bytes))
+        {
+            return nullptr;
+        }
+        memcpy(&bytes, in, sizeof(bytes));
+        in += sizeof(bytes);
+        if ((uint64_t)(end - in) < bytes || !ScanDataCodec::decode(in, bytes, scratch.data() + (size_t)k * count, count))
+        {
+            return nullptr;
+        }
+        in += bytes;
+    }
+    return scratch.data();
+}
+
+bool ScanDataReader::readRecord(const Position& position, Record& out)
+{
+    const int64_t record = find(position);
+    if (record < 0)
+    {
+        return fail("No record at (" + std::to_string(position.x) + ", " + std::to_string(position.y) + ", " + std::to_string(position.z) + ")");
+    }
+    return readRecord((size_t)record, out);
+}
+
+// Reads the trailing index the writer appended on close
+bool ScanDataReader::loadIndex()
+{
+    ScanDataFormat::IndexHeader header;
+    if (fileHeader.indexOffset + sizeof(header) > file.size())
+    {
+        return false;
+    }
+    memcpy(&header, file.data() + fileHeader.indexOffset, sizeof(header));
+    const uint64_t first = fileHeader.indexOffset + sizeof(header);
+    if (!ScanDataFormat::isValid(header) || header.entryCount > (file.size() - first) / header.entryBytes)
+    {
+        return false;
+    }
+    entries.resize(header.entryCount);
+    for (uint64_t i = 0; i < header.entryCount; i++)
+    {
+        memcpy(&entries[i], file.data() + first + i * header.entryBytes, sizeof(ScanDataFormat::IndexEntry));
+    }
+    return true;
+}
+
+// Walks the record headers of a file without an index (e.g. the session ended before close()); a truncated
+// last record is left out
+void ScanDataReader::rebuildIndex()
+{
+    entries.clear();
+    const uint64_t end = fileHeader.indexOffset && fileHeader.indexOffset <= file.size() ? fileHeader.indexOffset : file.size();
+    uint64_t offset = fileHeader.fileHeaderBytes;
+    ScanDataFormat::RecordHeader header;
+    while (offset + sizeof(header) <= end)
+    {
+        memcpy(&header, file.data() + offset, sizeof(header));
+        if (!ScanDataFormat::isValid(header) || offset + header.recordBytes > end)
+        {
+            break;
+        }
+        entries.push_back({ header.x, header.y, header.z, header.recordBytes, offset });
+        offset += header.recordBytes;
+    }
+}
+
+bool ScanDataReader::fail(const std::string& message)
+{
+    error = message;
+    return false;
+}
@@ -0,0 +1,112 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SCANDATAREADER_H  // Include guard to prevent multiple inclusions
+#define SCANDATAREADER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "MappedFile.h"
+#include "ScanDataFormat.h"
+
+// Random access to a scan data file written by ScanDataWriter. The file is memory mapped: open() reads the
+// file header and the trailing index (or, for a file that was never closed, walks the record headers once
+// to rebuild it) and hashes the positions, so find() is one lookup and record() hands out spans straight
+// over the mapped samples without reading or copying anything (compressed records are decoded on request). Opening a 10 GB scan takes as long as its
+// index. The reader has no Qt dependency and is shared with ScanDataTool; after open() every const member
+// may be called from several threads at once.
+class ScanDataReader
+{
+public:
+    struct Position
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+        int32_t z = 0;
+        bool operator==(const Position& other) const { return x == other.x && y == other.y && z == other.z; }
+    };
+
+    // One record in the mapped file; valid while the reader stays open. The samples of a raw record are
+    // used in place; a compressed record only points to its encoded bytes (see decode()).
+    struct RecordView
+    {
+        ScanDataFormat::RecordHeader header{};
+        const int16_t* samples = nullptr;  // ADC counts, channel-major; null unless the record is raw
+        const uint8_t* encoded = nullptr;  // Compressed record: the encoded channels
+        uint64_t encodedBytes = 0;
+
+        bool valid() const { return samples != nullptr || encoded != nullptr; }
+        bool compressed() const { return encoded != nullptr; }
+        bool hasChannel(int channel) const { return channel >= 0 && channel < ScanDataFormat::maxChannels && (header.channelMask >> channel) & 1; }
+        std::span<const int16_t> channel(int channel) const;  // Empty if the channel is not in the record (or compressed)
+        int64_t timeAt(size_t i) const { return header.t0Ns + (int64_t)i * header.intervalNs; }  // ns
+    };
+
+    // A record copied (and decoded) out of the file
+    struct Record
+    {
+        ScanDataFormat::RecordHeader header{};
+        std::vector<int16_t> samples;  // ADC counts, channel-major
+
+        bool hasChannel(int channel) const { return channel >= 0 && channel < ScanDataFormat::maxChannels && (header.channelMask >> channel) & 1; }
+        std::span<const int16_t> channel(int channel) const;
+        int64_t timeAt(size_t i) const { return header.t0Ns + (int64_t)i * header.intervalNs; }  // ns
+    };
+
+    ScanDataReader() = default;
+    explicit ScanDataReader(const std::filesystem::path& path) { open(path); }
+
+    bool open(const std::filesystem::path& path);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    const std::filesystem::path& path() const { return filePath; }
+    uint64_t fileSize() const { return file.size(); }
+
+    const ScanDataFormat::FileHeader& header() const { return fileHeader; }
+    bool indexed() const { return fromIndex; }  // False if the index had to be rebuilt from the records
+    size_t recordCount() const { return entries.size(); }
+    const std::vector<ScanDataFormat::IndexEntry>& index() const { return entries; }  // File order
+
+    // Record number at a position, or -1; a position recorded more than once gives its last record
+    int64_t find(const Position& position) const;
+    RecordView record(size_t record) const;  // Zero copy
+    RecordView record(const Position& position) const;
+    bool readRecord(size_t record, Record& out);  // Copies the record, decoding it if compressed
+    bool readRecord(const Position& position, Record& out);
+    // Samples of a record, channel-major: in place for a raw record, otherwise decoded into scratch.
+    // Null for an invalid or corrupt record.
+    const int16_t* decode(const RecordView& record, std::vector<int16_t>& scratch) const;
+
+    double mvPerCount(const ScanDataFormat::RecordHeader& record, int channel) const { return ScanDataFormat::mvPerCount(fileHeader, record.range[channel]); }
+
+    std::string lastError() const { return error; }
+
+private:
+    struct PositionHash
+    {
+        size_t operator()(const Position& p) const
+        {
+            return std::hash<uint64_t>()(((uint64_t)(uint32_t)p.x * 73856093u) ^ ((uint64_t)(uint32_t)p.y << 21) ^ ((uint64_t)(uint32_t)p.z << 42));
+        }
+    };
+
+    bool loadIndex();
+    void rebuildIndex();
+    bool fail(const std::string& message);
+
+    std::filesystem::path filePath;
+    MappedFile file;
+    ScanDataFormat::FileHeader fileHeader{};
+    std::vector<ScanDataFormat::IndexEntry> entries;
+    std::unordered_map<Position, size_t, PositionHash> positions;
+    bool fromIndex = false;
+    std::string error;
+};
+
+#endif // SCANDATAREADER_H
@@ -0,0 +1,415 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+// Command-line tool for scan data files (ScanDataTool.vcxproj, no Qt):
+//
+//   ScanDataTool info <file>                     file header and record summary
+//   ScanDataTool list <file>                     index: record, position, offset, size
+//   ScanDataTool extract <file> <x> <y> <z> [out.csv]
+//                                                one record as CSV (t in ns, mV per channel); stdout by default
+//   ScanDataTool csv <file> <out.csv>            every record as CSV, one row per sample
+//   ScanDataTool npy <file> <out.npy> [--mv]     records x channels x samples as int16 counts (float32 mV
+//                                                with --mv) and the positions as <out>_positions.npy
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "ScanDataCodec.h"
+#include "ScanDataReader.h"
+
+namespace
+{
+    const char* channelNames[ScanDataFormat::maxChannels] = { "A", "B", "C", "D" };
+
+    int usage()
+    {
+        fprintf(stderr,
+            "Usage:\n"
+            "  ScanDataTool info <file>\n"
+            "  ScanDataTool list <file>\n"
+            "  ScanDataTool extract <file> <x> <y> <z> [out.csv]\n"
+            "  ScanDataTool csv <file> <out.csv>\n"
+            "  ScanDataTool npy <file> <out.npy> [--mv]\n");
+        return 2;
+    }
+
+    // Output file with a large buffer; numbers are formatted with to_chars, which is far faster than printf
+    class Output
+    {
+    public:
+        explicit Output(FILE* file) : file(file) { buffer.reserve(capacity); }
+        ~Output() { flush(); }
+        void text(const char* s) { text(s, strlen(s)); }
+        void text(const char* s, size_t n) { reserve(n); buffer.append(s, n); }
+        void put(char c) { reserve(1); buffer.push_back(c); }
+        template <typename T> void number(T value)
+        {
+            char digits[32];
+            const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+            text(digits, result.ptr - digits);
+        }
+        void flush()
+        {
+            if (!buffer.empty())
+            {
+                ok = ok && fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+                buffer.clear();
+            }
+        }
+        bool good() { flush(); return ok; }
+
+    private:
+        void reserve(size_t n) { if (buffer.size() + n > capacity) flush(); }
+        static constexpr size_t capacity = 4 << 20;
+        FILE* file;
+        std::string buffer;
+        bool ok = true;
+    };
+
+    bool openReader(ScanDataReader& reader, const char* path)
+    {
+        if (!reader.open(std::filesystem::u8path(path)))
+        {
+            fprintf(stderr, "%s\n", reader.lastError().c_str());
+            return false;
+        }
+        if (!reader.indexed())
+        {
+            fprintf(stderr, "Note: %s has no index (not closed by the writer); %zu complete records found\n", path, reader.recordCount());
+        }
+        return true;
+    }
+
+    FILE* openOutput(const char* path)
+    {
+        FILE* file = fopen(path, "wb");
+        if (!file)
+        {
+            fprintf(stderr, "Unable to create %s\n", path);
+        }
+        return file;
+    }
+
+    int info(const ScanDataReader& reader)
+    {
+        const ScanDataFormat::FileHeader& h = reader.header();
+        printf("File:            %s\n", reader.path().string().c_str());
+        printf("Size:            %.3f MB\n", reader.fileSize() / 1e6);
+        printf("Version:         %u\n", (unsigned)h.version);
+        printf("Created:         %lld ms since 1970-01-01 UTC\n", (long long)h.createdUnixMs);
+        printf("Device:          %.*s\n", (int)sizeof(h.deviceModel), h.deviceModel);
+        printf("Timebase:        %u (%d ns per sample)\n", h.timebase, h.intervalNs);
+        printf("Samples/record:  %u\n", h.samplesPerRecord);
+        for (int channel = 0; channel < ScanDataFormat::maxChannels; channel++)
+        {
+            if ((h.channelMask >> channel) & 1)
+            {
+                printf("Channel %s:       +/-%u mV, %s\n", channelNames[channel],
+                    h.range[channel] >= 0 && h.range[channel] < 16 ? h.rangeMillivolts[h.range[channel]] : 0u, h.dcCoupled[channel] ? "DC" : "AC");
+            }
+        }
+        if (h.triggerEnabled)
+        {
+            printf("Trigger:         channel %s, %s edge, %d mV\n", h.triggerChannel >= 0 && h.triggerChannel < 4 ? channelNames[h.triggerChannel] : "?",
+                h.triggerDirection == ScanDataFormat::Falling ? "falling" : "rising", h.triggerThresholdMv);
+        }
+        else
+        {
+            printf("Trigger:         none\n");
+        }
+        printf("Waveform:        %d Hz, %d mVpp, %d ms pulses, %d %% duty, %d Hz PRF, %d s\n", h.waveformFrequencyHz, h.waveformAmplitudeMv,
+            h.waveformPulseDurationMs, h.waveformDutyCycle, h.waveformPrfHz, h.waveformLengthS);
+        printf("Records:         %zu (%s)\n", reader.recordCount(), reader.indexed() ? "indexed" : "index rebuilt");
+        printf("Codec:           %s\n", ScanDataCodec::name((uint8_t)h.recordCodec));
+
+        if (reader.recordCount())
+        {
+            int32_t lo[3] = { INT32_MAX, INT32_MAX, INT32_MAX };
+            int32_t hi[3] = { INT32_MIN, INT32_MIN, INT32_MIN };
+            for (const ScanDataFormat::IndexEntry& e : reader.index())
+            {
+                const int32_t p[3] = { e.x, e.y, e.z };
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    lo[axis] = p[axis] < lo[axis] ? p[axis] : lo[axis];
+                    hi[axis] = p[axis] > hi[axis] ? p[axis] : hi[axis];
+                }
+            }
+            printf("Extent:          x %d..%d, y %d..%d, z %d..%d\n", lo[0], hi[0], lo[1], hi[1], lo[2], hi[2]);
+        }
+        return 0;
+    }
+
+    int list(const ScanDataReader& reader)
+    {
+        Output out(stdout);
+        out.text("record,x,y,z,offset,bytes\n");
+        for (size_t i = 0; i < reader.recordCount(); i++)
+        {
+            const ScanDataFormat::IndexEntry& e = reader.index()[i];
+            out.number(i); out.put(',');
+            out.number(e.x); out.put(',');
+            out.number(e.y); out.put(',');
+            out.number(e.z); out.put(',');
+            out.number(e.offset); out.put(',');
+            out.number(e.recordBytes); out.put('\n');
+        }
+        return out.good() ? 0 : 1;
+    }
+
+    // Rows of t and mV per channel of columnMask (empty for a channel the record lacks), prefixed by prefix;
+    // data holds the record's samples, channel-major
+    void writeCsvRows(Output& out, const ScanDataReader& reader, const ScanDataFormat::RecordHeader& header, const int16_t* data,
+        uint32_t columnMask, const std::string& prefix)
+    {
+        const int16_t* samples[ScanDataFormat::maxChannels];
+        double scale[ScanDataFormat::maxChannels];
+        int columns = 0;
+        for (int channel = 0; channel < ScanDataFormat::maxChannels; channel++)
+        {
+            if ((columnMask >> channel) & 1)
+            {
+                const bool present = (header.channelMask >> channel) & 1;
+                samples[columns] = present ? data + (size_t)ScanDataFormat::channelBlock(header.channelMask, channel) * header.sampleCount : nullptr;
+                scale[columns++] = reader.mvPerCount(header, channel);
+            }
+        }
+        for (uint32_t i = 0; i < header.sampleCount; i++)
+        {
+            out.text(prefix.data(), prefix.size());
+            out.number(header.t0Ns + (int64_t)i * header.intervalNs);
+            for (int k = 0; k < columns; k++)
+            {
+                out.put(',');
+                if (samples[k])
+                {
+                    out.number(samples[k][i] * scale[k]);
+                }
+            }
+            out.put('\n');
+        }
+    }
+
+    void writeCsvHeader(Output& out, uint32_t channelMask, bool withPosition)
+    {
+        out.text(withPosition ? "record,x,y,z,t_ns" : "t_ns");
+        for (int channel = 0; channel < ScanDataFormat::maxChannels; channel++)
+        {
+            if ((channelMask >> channel) & 1)
+            {
+                out.text(",");
+                out.text(channelNames[channel]);
+                out.text("_mV");
+            }
+        }
+        out.put('\n');
+    }
+
+    int extract(const ScanDataReader& reader, int32_t x, int32_t y, int32_t z, const char* path)
+    {
+        const ScanDataReader::RecordView record = reader.record({ x, y, z });
+        std::vector<int16_t> scratch;
+        const int16_t* samples = reader.decode(record, scratch);
+        if (!samples)
+        {
+            fprintf(stderr, record.valid() ? "Corrupt record at (%d, %d, %d)\n" : "No record at (%d, %d, %d)\n", x, y, z);
+            return 1;
+        }
+        FILE* file = path ? openOutput(path) : stdout;
+        if (!file)
+        {
+            return 1;
+        }
+        bool ok;
+        {
+            Output out(file);
+            writeCsvHeader(out, record.header.channelMask, false);
+            writeCsvRows(out, reader, record.header, samples, record.header.channelMask, "");
+            ok = out.good();
+        }
+        if (path)
+        {
+            ok = fclose(file) == 0 && ok;
+        }
+        return ok ? 0 : 1;
+    }
+
+    int csv(const ScanDataReader& reader, const char* path)
+    {
+        FILE* file = openOutput(path);
+        if (!file)
+        {
+            return 1;
+        }
+        bool ok;
+        {
+            Output out(file);
+            // Columns of the channels enabled for the file
+            writeCsvHeader(out, reader.header().channelMask, true);
+            std::vector<int16_t> scratch;
+            for (size_t i = 0; i < reader.recordCount(); i++)
+            {
+                const ScanDataReader::RecordView record = reader.record(i);
+                const int16_t* samples = reader.decode(record, scratch);
+                if (!samples)
+                {
+                    fprintf(stderr, "Skipping corrupt record %zu\n", i);
+                    continue;
+                }
+                const std::string prefix = std::to_string(i) + "," + std::to_string(record.header.x) + "," +
+                    std::to_string(record.header.y) + "," + std::to_string(record.header.z) + ",";
+                writeCsvRows(out, reader, record.header, samples, reader.header().channelMask, prefix);
+            }
+            ok = out.good();
+        }
+        return fclose(file) == 0 && ok ? 0 : 1;
+    }
+
+    // NPY 1.0 header: magic, version, little-endian header length, then the dict padded to 64 bytes
+    bool writeNpyHeader(FILE* file, const char* descr, const std::vector<uint64_t>& shape)
+    {
+        std::string dict = std::string("{'descr': '") + descr + "', 'fortran_order': False, 'shape': (";
+        for (uint64_t n : shape)
+        {
+            dict += std::to_string(n) + ", ";
+        }
+        dict += "), }";
+        const size_t unpadded = 10 + dict.size() + 1;
+        dict.append((64 - unpadded % 64) % 64, ' ');
+        dict += '\n';
+        const uint16_t length = (uint16_t)dict.size();
+        const char preamble[8] = { '\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0 };
+        return fwrite(preamble, 1, 8, file) == 8 && fwrite(&length, 2, 1, file) == 1 && fwrite(dict.data(), 1, dict.size(), file) == dict.size();
+    }
+
+    int npy(const ScanDataReader& reader, const std::string& path, bool millivolts)
+    {
+        if (reader.recordCount() == 0)
+        {
+            fprintf(stderr, "No records\n");
+            return 1;
+        }
+        // A dense array needs every record to have the same shape
+        const ScanDataReader::RecordView first = reader.record(0);
+        const uint32_t channelMask = first.header.channelMask;
+        const uint32_t samples = first.header.sampleCount;
+        const int channels = ScanDataFormat::channelCount(channelMask);
+        for (size_t i = 0; i < reader.recordCount(); i++)
+        {
+            const ScanDataReader::RecordView record = reader.record(i);
+            if (!record.valid() || record.header.channelMask != channelMask || record.header.sampleCount != samples)
+            {
+                fprintf(stderr, "Record %zu differs in channels or length from record 0; use csv instead\n", i);
+                return 1;
+            }
+        }
+
+        FILE* file = openOutput(path.c_str());
+        if (!file)
+        {
+            return 1;
+        }
+        const std::vector<uint64_t> shape = { reader.recordCount(), (uint64_t)channels, samples };
+        bool ok = writeNpyHeader(file, millivolts ? "<f4" : "<i2", shape);
+        std::vector<float> mv(millivolts ? samples : 0);
+        std::vector<int16_t> scratch;
+        for (size_t i = 0; ok && i < reader.recordCount(); i++)
+        {
+            const ScanDataReader::RecordView record = reader.record(i);
+            const int16_t* data = reader.decode(record, scratch);
+            if (!data)
+            {
+                fprintf(stderr, "Corrupt record %zu\n", i);
+                ok = false;
+                break;
+            }
+            if (!millivolts)
+            {
+                // Already channel-major int16, exactly the layout of one row of the array
+                ok = fwrite(data, sizeof(int16_t), (size_t)channels * samples, file) == (size_t)channels * samples;
+                continue;
+            }
+            for (int channel = 0; ok && channel < ScanDataFormat::maxChannels; channel++)
+            {
+                if (record.hasChannel(channel))
+                {
+                    const int16_t* counts = data + (size_t)ScanDataFormat::channelBlock(channelMask, channel) * samples;
+                    const float scale = (float)reader.mvPerCount(record.header, channel);
+                    for (uint32_t s = 0; s < samples; s++)
+                    {
+                        mv[s] = counts[s] * scale;
+                    }
+                    ok = fwrite(mv.data(), sizeof(float), samples, file) == samples;
+                }
+            }
+        }
+        ok = fclose(file) == 0 && ok;
+
+        std::string positionsPath = path;
+        const size_t dot = positionsPath.rfind(".npy");
+        positionsPath = (dot == std::string::npos ? positionsPath : positionsPath.substr(0, dot)) + "_positions.npy";
+        FILE* positions = ok ? openOutput(positionsPath.c_str()) : nullptr;
+        if (positions)
+        {
+            ok = writeNpyHeader(positions, "<i4", { reader.recordCount(), 3 });
+            for (const ScanDataFormat::IndexEntry& e : reader.index())
+            {
+                const int32_t p[3] = { e.x, e.y, e.z };
+                ok = ok && fwrite(p, sizeof(int32_t), 3, positions) == 3;
+            }
+            ok = fclose(positions) == 0 && ok;
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "Error writing %s\n", path.c_str());
+            return 1;
+        }
+        printf("%s: %zu records x %d channels x %u samples (%s)\n%s: positions\n", path.c_str(), reader.recordCount(), channels, samples,
+            millivolts ? "float32 mV" : "int16 counts", positionsPath.c_str());
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        return usage();
+    }
+    const std::string command = argv[1];
+    ScanDataReader reader;
+    if (command != "info" && command != "list" && command != "extract" && command != "csv" && command != "npy")
+    {
+        return usage();
+    }
+    if (!openReader(reader, argv[2]))
+    {
+        return 1;
+    }
+
+    if (command == "info")
+    {
+        return info(reader);
+    }
+    if (command == "list")
+    {
+        return list(reader);
+    }
+    if (command == "extract" && (argc == 6 || argc == 7))
+    {
+        return extract(reader, atoi(argv[3]), atoi(argv[4]), atoi(argv[5]), argc == 7 ? argv[6] : nullptr);
+    }
+    if (command == "csv" && argc == 4)
+    {
+        return csv(reader, argv[3]);
+    }
+    if (command == "npy" && (argc == 4 || (argc == 5 && strcmp(argv[4], "--mv") == 0)))
+    {
+        return npy(reader, argv[3], argc == 5);
+    }
+    return usage();
+}
@@ -0,0 +1,414 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "ScanDataWriter.h"
+#include <cstddef>
+#include <cstring>
+#include "ScanDataCodec.h"
+
+ScanDataWriter::ScanDataWriter(size_t bufferBytes, size_t maxQueuedBytes) :
+    bufferCapacity(bufferBytes > 4096 ? bufferBytes : 4096), maxQueued(maxQueuedBytes)
+{
+}
+
+ScanDataWriter::~ScanDataWriter()
+{
+    close();
+}
+
+void ScanDataWriter::setCompression(bool enabled, int threads)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    compress = enabled;
+    const int cores = (int)std::thread::hardware_concurrency();
+    compressorCount = threads > 0 ? threads : (cores > 2 ? cores - 1 : 1);  // Leaves a core for acquisition and the GUI
+}
+
+bool ScanDataWriter::open(const std::filesystem::path& path, const ScanDataFormat::FileHeader& fileHeader)
+{
+    close();
+    std::lock_guard<std::mutex> lock(mutex);
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        failed = true;
+        error = "Unable to open file for writing: " + path.string();
+        return false;
+    }
+    filePath = path;
+    buffer.clear();
+    buffer.reserve(bufferCapacity);
+    queue.clear();
+    claimed = 0;
+    queuedBytes = 0;
+    itemsQueued = 0;
+    itemsDone = 0;
+    itemsFlushed = 0;
+    flushRequested = false;
+    stopRequested = false;
+    stopCompressors = false;
+    failed = false;
+    error.clear();
+    records = 0;
+    bytesWritten = 0;
+    writeSeconds = 0;
+    rawBytes = 0;
+    storedBytes = 0;
+    compressSeconds = 0;
+    nextRecordIndex = 0;
+    ScanDataFormat::FileHeader header = fileHeader;
+    header.recordCodec = compress ? ScanDataCodec::DeltaBitPack : ScanDataCodec::Raw;
+    fileOffset = sizeof(header);
+    index.clear();
+    buffer.insert(buffer.end(), (const char*)&header, (const char*)&header + sizeof(header));
+    openedAt = std::chrono::steady_clock::now();
+    running = true;
+    writer = std::thread(&ScanDataWriter::writerLoop, this);
+    for (int i = 0; compress && i < compressorCount; i++)
+    {
+        compressors.emplace_back(&ScanDataWriter::compressorLoop, this);
+    }
+    return true;
+}
+
+bool ScanDataWriter::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+size_t ScanDataWriter::recordBytes(const PicoCapture& capture)
+{
+    return sizeof(ScanDataFormat::RecordHeader) + (size_t)capture.size() * sizeof(int16_t) * capture.channelCount();
+}
+
+bool ScanDataWriter::writeCapture(const Position& position, const PicoCapture& capture)
+{
+    Item item;
+    item.capture = capture;
+    item.size = recordBytes(capture);
+
+    // Everything but the record index and size, which the writer thread fills in
+    ScanDataFormat::RecordHeader& header = item.header;
+    memset(&header, 0, sizeof(header));
+    header.magic = ScanDataFormat::recordMagic;
+    header.x = position.x;
+    header.y = position.y;
+    header.z = position.z;
+    header.sampleCount = capture.size();
+    header.timestampUnixNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    header.t0Ns = capture.t0();
+    header.intervalNs = capture.dt();
+    header.channelMask = (uint16_t)capture.channelMask();
+    header.codec = ScanDataCodec::Raw;
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        if (capture.hasChannel(channel))
+        {
+            header.range[channel] = capture.range(channel);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    // Back-pressure: wait while the disk is more than maxQueued bytes behind
+    queueChanged.wait(lock, [this] { return !running || queue.empty() || queuedBytes < maxQueued; });
+    if (!running || failed)
+    {
+        return false;
+    }
+    item.ready = compressors.empty();  // Otherwise a compressor marks it ready
+    queuedBytes += item.size;
+    itemsQueued++;
+    queue.push_back(std::move(item));
+    itemQueued.notify_one();
+    compressWanted.notify_one();
+    return true;
+}
+
+bool ScanDataWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!running)
+    {
+        return !failed;
+    }
+    const uint64_t target = itemsQueued;
+    flushRequested = true;
+    itemQueued.notify_one();
+    queueChanged.wait(lock, [this, target] { return !running || itemsFlushed >= target; });
+    return !failed;
+}
+
+void ScanDataWriter::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+        itemQueued.notify_one();
+    }
+    if (writer.joinable())
+    {
+        writer.join();  // Waits for the compressors to finish what is queued
+        writeIndex();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopCompressors = true;
+        compressWanted.notify_all();
+    }
+    for (std::thread& compressor : compressors)
+    {
+        compressor.join();
+    }
+    compressors.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file.is_open())
+    {
+        file.close();
+    }
+    running = false;
+    queueChanged.notify_all();
+}
+
+ScanDataWriter::Stats ScanDataWriter::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    stats.records = records;
+    stats.bytesWritten = bytesWritten;
+    stats.bytesQueued = queuedBytes;
+    stats.writeSeconds = writeSeconds;
+    stats.rawBytes = rawBytes;
+    stats.storedBytes = storedBytes;
+    stats.compressSeconds = compressSeconds;
+    stats.compressThreads = compress ? compressorCount : 0;
+    if (running || bytesWritten)
+    {
+        stats.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - openedAt).count();
+    }
+    return stats;
+}
+
+std::string ScanDataWriter::lastError() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+void ScanDataWriter::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        // Records go out in queue order, so the writer waits for the oldest to be compressed
+        itemQueued.wait(lock, [this] { return queue.empty() ? stopRequested || flushRequested : queue.front().ready; });
+        if (!queue.empty())
+        {
+            Item item = std::move(queue.front());
+            queue.pop_front();
+            if (claimed > 0)
+            {
+                claimed--;
+            }
+            lock.unlock();
+            serialize(item);
+            const size_t size = item.size;
+            item = Item();  // Releases the capture's samples
+            lock.lock();
+            queuedBytes -= size;
+            itemsDone++;
+            queueChanged.notify_all();
+            continue;
+        }
+
+        // Queue drained: honour a pending flush or stop
+        lock.unlock();
+        writeBuffer();
+        file.flush();
+        lock.lock();
+        if (!file)
+        {
+            failed = true;
+            error = "Write error on " + filePath.string();
+        }
+        flushRequested = false;
+        itemsFlushed = itemsDone;
+        queueChanged.notify_all();
+        if (stopRequested)
+        {
+            break;
+        }
+    }
+}
+
+void ScanDataWriter::serialize(Item& item)
+{
+    // Structs and samples are stored little endian, which is the native order on the supported (x86/x64) targets
+    ScanDataFormat::RecordHeader& header = item.header;
+    header.recordIndex = nextRecordIndex++;
+    const uint64_t samples = ScanDataFormat::sampleBytes(header);
+    const uint64_t payload = header.codec == ScanDataCodec::Raw ? samples : item.encoded.size();
+    header.recordBytes = (uint32_t)(sizeof(header) + payload);
+    append(&header, sizeof(header));
+    index.push_back({ header.x, header.y, header.z, header.recordBytes, fileOffset });
+    fileOffset += header.recordBytes;
+
+    if (header.codec != ScanDataCodec::Raw)
+    {
+        append(item.encoded.data(), item.encoded.size());
+    }
+    else
+    {
+        // The ADC counts go out exactly as captured, one block per channel
+        for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+        {
+            if (item.capture.hasChannel(channel))
+            {
+                const std::span<const int16_t> raw = item.capture.raw(channel);
+                append(raw.data(), raw.size_bytes());
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    records++;
+    rawBytes += sizeof(header) + samples;
+    storedBytes += header.recordBytes;
+}
+
+// Compresses queued records, oldest first, on one of the compressor threads. Every channel becomes a
+// uint32_t byte count and its ScanDataCodec encoding; a record that would not shrink is left raw.
+void ScanDataWriter::compressorLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        compressWanted.wait(lock, [this] { return stopCompressors || claimed < queue.size(); });
+        if (claimed >= queue.size())
+        {
+            break;  // Stopping with nothing left to compress
+        }
+        // Every queued item is a record that stays unready until compressed, so the claimed items are the
+        // front of the queue and the writer, which only removes a ready front item, never removes one in use
+        Item& item = queue[claimed++];
+        lock.unlock();
+
+        const auto start = std::chrono::steady_clock::now();
+        const PicoCapture& capture = item.capture;
+        const int channels = capture.channelCount();
+        item.encoded.resize(channels * (sizeof(uint32_t) + ScanDataCodec::maxEncodedBytes(capture.size())));
+        uint8_t* out = item.encoded.data();
+        for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+        {
+            if (capture.hasChannel(channel))
+            {
+                const uint32_t bytes = (uint32_t)ScanDataCodec::encode(capture.samples(channel), capture.size(), out + sizeof(uint32_t));
+                memcpy(out, &bytes, sizeof(bytes));
+                out += sizeof(bytes) + bytes;
+            }
+        }
+        const size_t encodedBytes = out - item.encoded.data();
+        if (encodedBytes < ScanDataFormat::sampleBytes(item.header))
+        {
+            item.encoded.resize(encodedBytes);
+            item.header.codec = ScanDataCodec::DeltaBitPack;
+            item.capture = PicoCapture();  // The samples go back to their pool now rather than when written
+        }
+        else
+        {
+            item.encoded.clear();
+            item.encoded.shrink_to_fit();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        compressSeconds += seconds;
+        item.ready = true;
+        itemQueued.notify_one();
+    }
+}
+
+// Appends the index of all records written and points the file header to it. Runs once the writer thread has
+// stopped; a file whose writer failed keeps indexOffset 0 and is read by walking its records instead.
+void ScanDataWriter::writeIndex()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failed || !file.is_open())
+        {
+            return;
+        }
+    }
+    ScanDataFormat::IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ScanDataFormat::indexMagic, sizeof(header.magic));
+    header.entryCount = index.size();
+    header.entryBytes = sizeof(ScanDataFormat::IndexEntry);
+    const uint64_t indexOffset = fileOffset;
+    append(&header, sizeof(header));
+    append(index.data(), index.size() * sizeof(ScanDataFormat::IndexEntry));
+    writeBuffer();
+
+    const uint64_t recordCount = index.size();
+    file.seekp(offsetof(ScanDataFormat::FileHeader, indexOffset));
+    file.write((const char*)&indexOffset, sizeof(indexOffset));
+    file.write((const char*)&recordCount, sizeof(recordCount));
+    file.flush();
+    if (!file)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        failed = true;
+        error = "Unable to write the index of " + filePath.string();
+    }
+    index.clear();
+    index.shrink_to_fit();
+}
+
+void ScanDataWriter::append(const void* data, size_t size)
+{
+    const char* bytes = (const char*)data;
+    if (buffer.size() + size > bufferCapacity)
+    {
+        writeBuffer();
+    }
+    if (size >= bufferCapacity)
+    {
+        // Large blocks go to the file directly instead of through the buffer
+        writeOut(bytes, size);
+        return;
+    }
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void ScanDataWriter::writeBuffer()
+{
+    if (buffer.empty())
+    {
+        return;
+    }
+    writeOut(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+void ScanDataWriter::writeOut(const char* data, size_t size)
+{
+    auto start = std::chrono::steady_clock::now();
+    file.write(data, (std::streamsize)size);
+    const bool ok = (bool)file;
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ok)
+    {
+        bytesWritten += size;
+    }
+    else if (!failed)
+    {
+        failed = true;
+        error = "Write error on " + filePath.string();
+    }
+    writeSeconds += seconds;
+}
@@ -0,0 +1,135 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SCANDATAWRITER_H  // Include guard to prevent multiple inclusions
+#define SCANDATAWRITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PicoCapture.h"
+#include "ScanDataFormat.h"
+
+// Long-lived writer of scan data files. The file stays open from open() to close(); writeCapture()
+// only queues the capture (its samples are shared, not copied) and a background thread serializes
+// the records (see ScanDataFormat.h) into a large buffer that goes to disk in big writes. flush() waits until everything
+// queued so far is on disk. The queue is bounded: when the disk falls behind by more than
+// maxQueuedBytes, writeCapture() waits, so memory stays bounded on long scans. close() appends the
+// index of the records (ScanDataReader finds any position through it).
+// With setCompression() every record is compressed (ScanDataCodec) by a pool of compressor threads before
+// the writer thread takes it, in queue order; the acquisition only ever pays for queuing the record.
+class ScanDataWriter
+{
+public:
+    struct Position
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+        int32_t z = 0;
+    };
+
+    struct Stats
+    {
+        uint64_t records = 0;  // Records written to the file
+        uint64_t bytesWritten = 0;  // Bytes handed to the file
+        uint64_t bytesQueued = 0;  // Bytes waiting in the queue
+        double elapsedSeconds = 0;  // Since open()
+        double writeSeconds = 0;  // Time spent inside the file writes
+        uint64_t rawBytes = 0;  // Size the records written would have uncompressed
+        uint64_t storedBytes = 0;  // Size of the records written as stored
+        double compressSeconds = 0;  // Summed over the compressor threads
+        int compressThreads = 0;  // 0 without compression
+        double bytesPerSecond() const { return elapsedSeconds > 0 ? bytesWritten / elapsedSeconds : 0; }  // Sustained
+        double diskBytesPerSecond() const { return writeSeconds > 0 ? bytesWritten / writeSeconds : 0; }  // While writing
+        double compressionRatio() const { return storedBytes ? (double)rawBytes / storedBytes : 1; }
+        double compressBytesPerSecond() const { return compressSeconds > 0 ? rawBytes / compressSeconds : 0; }  // Per thread
+    };
+
+    explicit ScanDataWriter(size_t bufferBytes = 8 << 20, size_t maxQueuedBytes = 256 << 20);
+    ~ScanDataWriter();
+
+    // Compress the records of files opened from now on; threads 0 uses all cores but one
+    void setCompression(bool enabled, int threads = 0);
+
+    // Creates (or truncates) the file, writes header and starts the writer thread
+    bool open(const std::filesystem::path& path, const ScanDataFormat::FileHeader& header);
+    bool isOpen() const;
+    const std::filesystem::path& path() const { return filePath; }
+
+    bool writeCapture(const Position& position, const PicoCapture& capture);  // Queues one record
+
+    bool flush();  // Waits until everything queued is written and flushed; false after a write error
+    void close();  // Flushes, stops the thread, writes the index and closes the file
+
+    Stats stats() const;
+    std::string lastError() const;
+
+    static size_t recordBytes(const PicoCapture& capture);  // Size of the record writeCapture produces
+
+private:
+    struct Item
+    {
+        ScanDataFormat::RecordHeader header{};
+        PicoCapture capture;  // Released once compressed
+        std::vector<uint8_t> encoded;  // Compressed channels
+        size_t size = 0;  // Uncompressed size
+        bool ready = true;  // False until compressed
+    };
+
+    void writerLoop();
+    void compressorLoop();
+    void serialize(Item& item);  // Appends the record to buffer, writing it out whenever it fills up
+    void append(const void* data, size_t size);  // Through the buffer, or straight to the file when large
+    void writeBuffer();
+    void writeOut(const char* data, size_t size);
+    void writeIndex();
+
+    const size_t bufferCapacity;
+    const size_t maxQueued;
+    std::filesystem::path filePath;
+    std::ofstream file;
+    std::vector<char> buffer;  // Only touched by the writer thread
+    uint64_t nextRecordIndex = 0;  // Writer thread
+    uint64_t fileOffset = 0;  // Writer thread: file size once the buffer is written
+    std::vector<ScanDataFormat::IndexEntry> index;  // Writer thread: every record written so far
+
+    std::thread writer;
+    std::vector<std::thread> compressors;
+    mutable std::mutex mutex;
+    std::condition_variable itemQueued;  // Also signalled when an item becomes ready
+    std::condition_variable queueChanged;
+    std::condition_variable compressWanted;
+    std::deque<Item> queue;  // Elements keep their address while queued
+    size_t claimed = 0;  // Items at the front of queue taken by a compressor; every item is a record to compress
+    bool compress = false;
+    int compressorCount = 1;
+    bool stopCompressors = false;
+    size_t queuedBytes = 0;
+    uint64_t itemsQueued = 0;
+    uint64_t itemsDone = 0;  // Items serialized into the buffer
+    uint64_t itemsFlushed = 0;  // Items written and flushed to the file
+    bool flushRequested = false;
+    bool stopRequested = false;
+    bool running = false;
+    bool failed = false;
+    std::string error;
+
+    std::chrono::steady_clock::time_point openedAt;
+    uint64_t records = 0;
+    uint64_t bytesWritten = 0;
+    double writeSeconds = 0;
+    uint64_t rawBytes = 0;
+    uint64_t storedBytes = 0;
+    double compressSeconds = 0;
+};
+
+#endif // SCANDATAWRITER_H
@@ -0,0 +1,48 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SCANGRID_H  // Include guard to prevent multiple inclusions
+#define SCANGRID_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Regular grid of gantry positions (in um, see ScanPlan): count[axis] points from origin[axis], step[axis] apart.
+// Axes are 0 = x, 1 = y, 2 = z. Cells are numbered x-major, i.e. ((ix * ny) + iy) * nz + iz.
+struct ScanGrid
+{
+    int32_t origin[3] = { 0, 0, 0 };
+    int32_t step[3] = { 1, 1, 1 };
+    uint32_t count[3] = { 0, 0, 0 };
+
+    size_t points() const { return (size_t)count[0] * count[1] * count[2]; }
+    bool empty() const { return points() == 0; }
+    int32_t position(int axis, uint32_t i) const { return origin[axis] + (int32_t)i * step[axis]; }
+
+    // Grid index of a position on one axis, false if the position is not on the grid
+    bool indexOf(int axis, int32_t position, uint32_t& i) const
+    {
+        const int64_t offset = (int64_t)position - origin[axis];
+        if (step[axis] == 0 || offset % step[axis] != 0 || offset / step[axis] < 0 || offset / step[axis] >= count[axis])
+        {
+            return false;
+        }
+        i = (uint32_t)(offset / step[axis]);
+        return true;
+    }
+
+    bool cellOf(int32_t x, int32_t y, int32_t z, size_t& cell) const
+    {
+        uint32_t ix, iy, iz;
+        if (!indexOf(0, x, ix) || !indexOf(1, y, iy) || !indexOf(2, z, iz))
+        {
+            return false;
+        }
+        cell = ((size_t)ix * count[1] + iy) * count[2] + iz;
+        return true;
+    }
+};
+
+#endif // SCANGRID_H
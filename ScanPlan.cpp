@@ -0,0 +1,142 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "ScanPlan.h"
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+    // The gantry takes distances with one decimal (ArduinoDevice::write)
+    bool onGantryResolution(double mm)
+    {
+        return std::fabs(mm * 10 - std::round(mm * 10)) < 1e-6;
+    }
+}
+
+bool ScanPlan::valid(std::string& error) const
+{
+    bool used[3] = { false, false, false };
+    for (int level = 0; level < 3; level++)
+    {
+        if (order[level] < 0 || order[level] > 2 || used[order[level]])
+        {
+            error = "Axis order must name each axis once";
+            return false;
+        }
+        used[order[level]] = true;
+    }
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const Axis& a = axes[axis];
+        if (std::fabs(a.step) < 0.1 || !onGantryResolution(a.step) || !onGantryResolution(a.start) || !onGantryResolution(a.stop))
+        {
+            error = std::string(axisName(axis)) + ": start, stop and step must be multiples of 0.1 mm and the step at least 0.1 mm";
+            return false;
+        }
+    }
+    if (points() > UINT32_MAX)
+    {
+        error = "Too many points";
+        return false;
+    }
+    return true;
+}
+
+uint32_t ScanPlan::count(int axis) const
+{
+    const Axis& a = axes[axis];
+    if (a.step == 0)
+    {
+        return 0;
+    }
+    return (uint32_t)std::floor(std::fabs(a.stop - a.start) / std::fabs(a.step) + 1e-6) + 1;
+}
+
+ScanGrid ScanPlan::grid() const
+{
+    ScanGrid grid;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const Axis& a = axes[axis];
+        const int32_t step = (int32_t)std::lround(std::fabs(a.step) * micrometresPerMm);
+        grid.origin[axis] = (int32_t)std::lround(a.start * micrometresPerMm);
+        grid.step[axis] = a.stop < a.start ? -step : step;
+        grid.count[axis] = count(axis);
+    }
+    return grid;
+}
+
+// Walks the grid like a mixed-radix counter with order[2] as the fastest digit. In a serpentine path a digit
+// that reaches its end reverses direction rather than wrapping to 0 (a reflected Gray code), so exactly one
+// axis moves by one step between consecutive points.
+std::vector<ScanPoint> ScanPlan::path() const
+{
+    std::vector<ScanPoint> path;
+    const ScanGrid grid = this->grid();
+    if (grid.empty())
+    {
+        return path;
+    }
+    path.reserve(grid.points());
+
+    uint32_t index[3] = { 0, 0, 0 };
+    int direction[3] = { 1, 1, 1 };
+    for (;;)
+    {
+        ScanPoint point;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            point.index[axis] = index[axis];
+            point.position[axis] = grid.position(axis, index[axis]);
+        }
+        path.push_back(point);
+
+        int level = 2;
+        for (; level >= 0; level--)
+        {
+            const int axis = order[level];
+            if (serpentine)
+            {
+                const int64_t next = (int64_t)index[axis] + direction[axis];
+                if (next >= 0 && next < grid.count[axis])
+                {
+                    index[axis] = (uint32_t)next;
+                    break;
+                }
+                direction[axis] = -direction[axis];  // Stays at its end while the next slower axis steps
+            }
+            else
+            {
+                if (index[axis] + 1 < grid.count[axis])
+                {
+                    index[axis]++;
+                    break;
+                }
+                index[axis] = 0;  // Flies back to the start of the line
+            }
+        }
+        if (level < 0)
+        {
+            return path;
+        }
+    }
+}
+
+// The axes move one after another, so the travel is the sum of the per-axis distances
+double ScanPlan::travelMm() const
+{
+    const std::vector<ScanPoint> path = this->path();
+    int64_t travel = 0;
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            travel += std::abs((int64_t)path[i].position[axis] - path[i - 1].position[axis]);
+        }
+    }
+    return (double)travel / micrometresPerMm;
+}
@@ -0,0 +1,50 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SCANPLAN_H  // Include guard to prevent multiple inclusions
+#define SCANPLAN_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ScanGrid.h"
+
+// One point of a scan path: its position in um from the gantry origin and its grid index per axis
+struct ScanPoint
+{
+    int32_t position[3];
+    uint32_t index[3];
+};
+
+// Volume to scan: per axis the first and last position and the step in mm (relative to the gantry origin),
+// and the order the axes are traversed in. order[0] is the slowest (outermost) axis and order[2] the fastest.
+// A serpentine path reverses an axis' direction instead of flying back to its start, so every point is one
+// step from the previous one along a single axis; a raster path returns each line to its start.
+struct ScanPlan
+{
+    struct Axis
+    {
+        double start = 0;  // mm
+        double stop = 0;  // mm, reached if (stop - start) is a multiple of step
+        double step = 1;  // mm, the sign is taken from start -> stop
+    };
+
+    static constexpr int32_t micrometresPerMm = 1000;
+
+    Axis axes[3];  // 0 = x, 1 = y, 2 = z
+    int order[3] = { 0, 1, 2 };
+    bool serpentine = true;
+
+    bool valid(std::string& error) const;
+    uint32_t count(int axis) const;  // Points along the axis
+    size_t points() const { return (size_t)count(0) * count(1) * count(2); }
+    ScanGrid grid() const;  // Positions in um
+    std::vector<ScanPoint> path() const;  // Every point in traversal order
+    double travelMm() const;  // Gantry travel along path(), without the move to the first point
+
+    static const char* axisName(int axis) { return axis == 0 ? "X" : axis == 1 ? "Y" : "Z"; }
+};
+
+#endif // SCANPLAN_H
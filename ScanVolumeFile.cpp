@@ -0,0 +1,289 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "ScanVolumeFile.h"
+#include <cstring>
+
+namespace
+{
+    const char* channelNames[PicoCapture::maxChannels] = { "A", "B", "C", "D" };
+
+    // MAT v5 building blocks (MATLAB "MAT-File Format", level 5); every data element is padded to 8 bytes
+    enum MatType : uint32_t
+    {
+        miINT8 = 1,
+        miINT32 = 5,
+        miUINT32 = 6,
+        miSINGLE = 7,
+        miDOUBLE = 9,
+        miMATRIX = 14
+    };
+    enum MatClass : uint32_t
+    {
+        mxDOUBLE_CLASS = 6,
+        mxSINGLE_CLASS = 7
+    };
+
+    uint64_t padded(uint64_t bytes)
+    {
+        return (bytes + 7) / 8 * 8;
+    }
+
+    void appendTag(std::string& out, uint32_t type, uint32_t bytes)
+    {
+        out.append((const char*)&type, sizeof(type));
+        out.append((const char*)&bytes, sizeof(bytes));
+    }
+
+    void appendPadded(std::string& out, const void* data, size_t bytes)
+    {
+        out.append((const char*)data, bytes);
+        out.append(padded(bytes) - bytes, '\0');
+    }
+
+    // Everything of a numeric matrix up to its data: the matrix tag, flags, dimensions, name and data tag.
+    // dataBytes of data follow, then padding to 8 bytes.
+    std::string matMatrixHeader(const char* name, MatClass matClass, MatType dataType, const std::vector<uint32_t>& dims, uint64_t dataBytes)
+    {
+        std::string body;
+        appendTag(body, miUINT32, 8);
+        const uint32_t flags[2] = { matClass, 0 };
+        body.append((const char*)flags, sizeof(flags));
+        appendTag(body, miINT32, (uint32_t)(dims.size() * sizeof(int32_t)));
+        appendPadded(body, dims.data(), dims.size() * sizeof(int32_t));
+        appendTag(body, miINT8, (uint32_t)strlen(name));
+        appendPadded(body, name, strlen(name));
+        appendTag(body, dataType, (uint32_t)dataBytes);
+
+        std::string out;
+        appendTag(out, miMATRIX, (uint32_t)(body.size() + padded(dataBytes)));
+        return out + body;
+    }
+
+    std::string matVector(const char* name, const std::vector<double>& values)
+    {
+        std::string out = matMatrixHeader(name, mxDOUBLE_CLASS, miDOUBLE, { 1, (uint32_t)values.size() }, values.size() * sizeof(double));
+        appendPadded(out, values.data(), values.size() * sizeof(double));
+        return out;
+    }
+}
+
+// NPY 1.0 header: magic, version, little-endian header length, then the dict padded to 64 bytes
+std::string ScanVolumeFile::npyHeader(const char* descr, const std::vector<uint64_t>& shape)
+{
+    std::string dict = std::string("{'descr': '") + descr + "', 'fortran_order': False, 'shape': (";
+    for (uint64_t n : shape)
+    {
+        dict += std::to_string(n) + ", ";
+    }
+    dict += "), }";
+    const size_t unpadded = 10 + dict.size() + 1;
+    dict.append((64 - unpadded % 64) % 64, ' ');
+    dict += '\n';
+    const uint16_t length = (uint16_t)dict.size();
+    std::string header("\x93NUMPY\x01\x00", 8);
+    header.append((const char*)&length, sizeof(length));
+    return header + dict;
+}
+
+bool ScanVolumeFile::create(const std::filesystem::path& base, Format format, const ScanGrid& grid, const PicoCapture& first)
+{
+    close();
+    error.clear();
+    if (grid.empty() || first.empty())
+    {
+        return fail("Nothing to export: empty grid or capture");
+    }
+    fileFormat = format;
+    volumeGrid = grid;
+    sampleCount = first.size();
+    t0 = first.t0();
+    dt = first.dt();
+    channelMask = first.channelMask();
+    converted.resize(sampleCount);
+    written = 0;
+
+    const bool created = format == Format::Npy ? createNpy(base) : createMat(base);
+    if (!created)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool ScanVolumeFile::createNpy(const std::filesystem::path& base)
+{
+    const std::string header = npyHeader("<f4", { volumeGrid.count[0], volumeGrid.count[1], volumeGrid.count[2], sampleCount });
+    const uint64_t total = header.size() + (uint64_t)volumeGrid.points() * sampleCount * sizeof(float);
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        if (!((channelMask >> channel) & 1))
+        {
+            continue;
+        }
+        std::filesystem::path path = base;
+        path += std::string("_") + channelNames[channel] + ".npy";
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out.write(header.data(), (std::streamsize)header.size()))
+            {
+                return fail("Unable to create " + path.string());
+            }
+        }
+        std::error_code failure;
+        std::filesystem::resize_file(path, total, failure);  // Preallocates the array, zero filled
+        files.emplace_back(path, std::ios::binary | std::ios::in | std::ios::out);
+        if (failure || !files.back().is_open())
+        {
+            return fail("Unable to allocate " + path.string() + " (" + std::to_string(total / 1000000) + " MB)");
+        }
+        filePaths.push_back(path);
+        targets[channel] = { (int)files.size() - 1, header.size() };
+    }
+    return true;
+}
+
+bool ScanVolumeFile::createMat(const std::filesystem::path& base)
+{
+    const uint64_t arrayBytes = (uint64_t)volumeGrid.points() * sampleCount * sizeof(float);
+    if (arrayBytes + 256 > UINT32_MAX)
+    {
+        return fail("Volume too large for a MAT v5 variable (" + std::to_string(arrayBytes / 1000000) + " MB per channel); export NPY instead");
+    }
+
+    // 128-byte header: text, subsystem offset, version 0x0100 and the endian indicator "IM"
+    std::string out = "MATLAB 5.0 MAT-file, Platform: PCWIN64, Created by: FUS_Toolbox_Cpp_Qt";
+    out.resize(116, ' ');
+    out.append(8, '\0');
+    const uint16_t version = 0x0100;
+    out.append((const char*)&version, sizeof(version));
+    out += "IM";
+
+    // Axes first, so the arrays' offsets are known; then per channel the header of its array
+    std::vector<double> axis;
+    const char* axisNames[3] = { "x", "y", "z" };
+    for (int a = 0; a < 3; a++)
+    {
+        axis.resize(volumeGrid.count[a]);
+        for (uint32_t i = 0; i < volumeGrid.count[a]; i++)
+        {
+            axis[i] = volumeGrid.position(a, i) / 1000.0;  // um to mm
+        }
+        out += matVector(axisNames[a], axis);
+    }
+    axis.resize(sampleCount);
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        axis[i] = (double)(t0 + (int64_t)i * dt);
+    }
+    out += matVector("t", axis);
+
+    std::filesystem::path path = base;
+    path += ".mat";
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.write(out.data(), (std::streamsize)out.size()))
+        {
+            return fail("Unable to create " + path.string());
+        }
+    }
+    files.emplace_back();
+    filePaths.push_back(path);
+
+    uint64_t offset = out.size();
+    std::vector<std::string> arrayHeaders;
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        if ((channelMask >> channel) & 1)
+        {
+            arrayHeaders.push_back(matMatrixHeader(channelNames[channel], mxSINGLE_CLASS, miSINGLE,
+                { sampleCount, volumeGrid.count[0], volumeGrid.count[1], volumeGrid.count[2] }, arrayBytes));
+            targets[channel] = { 0, offset + arrayHeaders.back().size() };
+            offset += arrayHeaders.back().size() + padded(arrayBytes);
+        }
+    }
+
+    std::error_code failure;
+    std::filesystem::resize_file(path, offset, failure);  // Preallocates the arrays, zero filled
+    files[0].open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (failure || !files[0].is_open())
+    {
+        return fail("Unable to allocate " + path.string() + " (" + std::to_string(offset / 1000000) + " MB)");
+    }
+    size_t k = 0;
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        if ((channelMask >> channel) & 1)
+        {
+            const std::string& header = arrayHeaders[k++];
+            files[0].seekp((std::streamoff)(targets[channel].offset - header.size()));
+            files[0].write(header.data(), (std::streamsize)header.size());
+        }
+    }
+    files[0].flush();
+    return files[0].good() || fail("Unable to write " + path.string());
+}
+
+void ScanVolumeFile::close()
+{
+    for (std::fstream& file : files)
+    {
+        if (file.is_open())
+        {
+            file.close();
+        }
+    }
+    files.clear();
+    filePaths.clear();
+}
+
+bool ScanVolumeFile::write(int32_t x, int32_t y, int32_t z, const PicoCapture& capture)
+{
+    if (!isOpen())
+    {
+        return false;
+    }
+    uint32_t ix, iy, iz;
+    if (!volumeGrid.indexOf(0, x, ix) || !volumeGrid.indexOf(1, y, iy) || !volumeGrid.indexOf(2, z, iz))
+    {
+        return fail("Position (" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ") is not on the export grid");
+    }
+    if (capture.size() != sampleCount || capture.dt() != dt || capture.t0() != t0 || capture.channelMask() != channelMask)
+    {
+        return fail("Capture at (" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ") does not match the export's record layout");
+    }
+
+    const uint32_t* n = volumeGrid.count;
+    const uint64_t cell = fileFormat == Format::Npy ? ((uint64_t)ix * n[1] + iy) * n[2] + iz : ((uint64_t)iz * n[1] + iy) * n[0] + ix;
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        if (!capture.hasChannel(channel))
+        {
+            continue;
+        }
+        capture.toMillivolts(channel, converted.data());
+        std::fstream& file = files[targets[channel].file];
+        file.seekp((std::streamoff)(targets[channel].offset + cell * sampleCount * sizeof(float)));
+        if (!file.write((const char*)converted.data(), (std::streamsize)(sampleCount * sizeof(float))))
+        {
+            return fail("Write error on " + filePaths[targets[channel].file].string());
+        }
+    }
+    written++;
+    return true;
+}
+
+std::vector<std::filesystem::path> ScanVolumeFile::paths() const
+{
+    return filePaths;
+}
+
+bool ScanVolumeFile::fail(const std::string& message)
+{
+    error = message;
+    return false;
+}
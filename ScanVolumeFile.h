@@ -0,0 +1,78 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SCANVOLUMEFILE_H  // Include guard to prevent multiple inclusions
+#define SCANVOLUMEFILE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "PicoCapture.h"
+#include "ScanGrid.h"
+
+// Scan results written straight into an analysis-ready array file. create() lays out and preallocates the
+// whole file from the grid, the record length and the channels; write() converts a capture to mV and stores
+// it in place at its grid cell, so the file is complete when the scan ends and points never measured read 0.
+//
+//   Npy  one NumPy file per channel, <base>_<channel>.npy, float32 mV of shape (nx, ny, nz, samples)
+//   Mat  one MATLAB v5 file <base>.mat holding x, y, z (grid positions in mm), t (sample times in ns),
+//        and per channel a single array A, B, ... of size [samples, nx, ny, nz], i.e. A(:, ix, iy, iz)
+//
+// A MAT v5 variable holds at most 4 GB; create() refuses bigger volumes (use Npy for those).
+class ScanVolumeFile
+{
+public:
+    enum class Format
+    {
+        Npy,
+        Mat
+    };
+
+    ScanVolumeFile() = default;
+    ~ScanVolumeFile() { close(); }
+
+    // base is the path without extension; the first capture supplies the record length, time base and channels
+    bool create(const std::filesystem::path& base, Format format, const ScanGrid& grid, const PicoCapture& first);
+    bool isOpen() const { return !files.empty(); }
+    void close();
+
+    // Stores the capture at (x, y, z); false if the position is off the grid or the capture does not match
+    bool write(int32_t x, int32_t y, int32_t z, const PicoCapture& capture);
+
+    std::vector<std::filesystem::path> paths() const;  // Files created
+    uint64_t pointsWritten() const { return written; }
+    std::string lastError() const { return error; }
+
+    // Header of a C-order NPY 1.0 array, e.g. npyHeader("<f4", { nx, ny, nz, samples }); the data follows it
+    static std::string npyHeader(const char* descr, const std::vector<uint64_t>& shape);
+
+private:
+    struct Target
+    {
+        int file = 0;  // Index into files
+        uint64_t offset = 0;  // Of the channel's first value
+    };
+
+    bool createNpy(const std::filesystem::path& base);
+    bool createMat(const std::filesystem::path& base);
+    bool fail(const std::string& message);
+
+    Format fileFormat = Format::Npy;
+    ScanGrid volumeGrid;
+    uint32_t sampleCount = 0;
+    int64_t t0 = 0;
+    int32_t dt = 0;
+    uint32_t channelMask = 0;
+    std::vector<std::filesystem::path> filePaths;
+    std::vector<std::fstream> files;
+    Target targets[PicoCapture::maxChannels];
+    std::vector<float> converted;  // One channel of a record in mV
+    uint64_t written = 0;
+    std::string error;
+};
+
+#endif // SCANVOLUMEFILE_H
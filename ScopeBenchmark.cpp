@@ -0,0 +1,415 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+// Headless throughput benchmark of the acquisition path (ScopeBenchmark.vcxproj, no Qt, no Pico SDK).
+// SimulatedScopeDriver runs as fast as possible through the same calls PicoScope::acquisitionLoop and
+// PicoScope::streamProducer make, so a change to the driver interface, CaptureBufferPool, BoundedQueue or
+// RingBuffer shows up here as a change in throughput or latency:
+//
+//   ScopeBenchmark block [samples] [captures] [channels]
+//        two memory segments armed alternately; each block is waited for on a BLOCK_CONTEXT, read with
+//        getValuesBulk into pooled buffers and queued to a consumer thread while the other segment captures
+//   ScopeBenchmark stream [overview samples] [total samples]
+//        runStreaming on channel A, getStreamingLatestValues into a RingBuffer drained by a second thread
+//
+// Exits with 1 if a driver call fails or a capture is lost.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.h"
+#include "CaptureBufferPool.h"
+#include "LatencyHistogram.h"
+#include "RingBuffer.h"
+#include "SimulatedScopeDriver.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int usage()
+    {
+        fprintf(stderr,
+            "Usage:\n"
+            "  ScopeBenchmark block [samples] [captures] [channels]\n"
+            "  ScopeBenchmark stream [overview samples] [total samples]\n");
+        return 2;
+    }
+
+    double secondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    bool check(PICO_STATUS status, const char* call)
+    {
+        if (status != PICO_OK)
+        {
+            fprintf(stderr, "%s ------ %u\n", call, (unsigned)status);
+            return false;
+        }
+        return true;
+    }
+
+    // Same as CallBackBlock for a BLOCK_CONTEXT parameter
+    void PREF4 blockReady(int16_t handle, PICO_STATUS status, void* pParameter)
+    {
+        ((BLOCK_CONTEXT*)pParameter)->signal(status);
+    }
+
+    // Opens the simulated unit with the first channelCount channels enabled at +-1 V
+    bool openUnit(SimulatedScopeDriver& driver, UNIT_MODEL& unit, int channelCount)
+    {
+        memset(&unit, 0, sizeof(UNIT_MODEL));
+        if (!check(driver.openUnit(&unit.handle), "openUnit"))
+        {
+            return false;
+        }
+        driver.getInfo(&unit);
+        for (int channel = 0; channel < MAX_CHANNELS; channel++)
+        {
+            unit.channelSettings[channel].DCcoupled = 1;
+            unit.channelSettings[channel].range = PS4000_1V;
+            unit.channelSettings[channel].enabled = channel < channelCount;
+        }
+        driver.setDefaults(&unit);
+        return true;
+    }
+
+    // First valid timebase for sampleCount samples, as PicoScope::configureBlock searches it
+    uint32_t findTimebase(SimulatedScopeDriver& driver, int16_t handle, int32_t sampleCount, int32_t& timeInterval)
+    {
+        uint32_t timebase = 0;
+        int32_t maxSamples = 0;
+        while (driver.getTimebase(handle, timebase, sampleCount, &timeInterval, 1, &maxSamples, 0) != PICO_OK)
+        {
+            timebase++;
+        }
+        return timebase;
+    }
+
+    struct Capture
+    {
+        std::array<std::shared_ptr<CaptureBuffer>, MAX_CHANNELS> buffers;
+        uint32_t samples = 0;
+        uint64_t index = 0;
+        Clock::time_point readyTime;
+    };
+
+    int blockBenchmark(int32_t sampleCount, uint64_t captures, int channelCount)
+    {
+        SimulatedScopeDriver::Settings settings;
+        settings.realTime = false;
+        SimulatedScopeDriver driver(settings);
+        UNIT_MODEL unit;
+        if (!openUnit(driver, unit, channelCount))
+        {
+            return 1;
+        }
+        uint32_t channelMask = 0;
+        for (int channel = 0; channel < channelCount; channel++)
+        {
+            channelMask |= 1u << channel;
+        }
+
+        // Rising edge on channel A half way up the burst, as applyTrigger sets it
+        const int16_t threshold = (int16_t)(settings.amplitudeMv / 2 * PS4000_MAX_VALUE / 1000);
+        struct tTriggerChannelProperties sourceDetails = { threshold, 0, threshold, 0, PS4000_CHANNEL_A, LEVEL };
+        struct tTriggerConditions conditions = { CONDITION_TRUE, CONDITION_DONT_CARE, CONDITION_DONT_CARE,
+            CONDITION_DONT_CARE, CONDITION_DONT_CARE, CONDITION_DONT_CARE, CONDITION_DONT_CARE };
+        struct tTriggerDirections directions = { RISING, NONE, NONE, NONE, NONE, NONE };
+        struct tPwq pulseWidth;
+        memset(&pulseWidth, 0, sizeof(struct tPwq));
+        driver.setTrigger(unit.handle, &sourceDetails, 1, &conditions, 1, &directions, &pulseWidth, 0, 0, 0);
+
+        int32_t timeInterval = 0;
+        const uint32_t timebase = findTimebase(driver, unit.handle, sampleCount, timeInterval);
+        int32_t maxSamples = 0;
+        uint16_t segments = driver.memorySegments(unit.handle, 2, &maxSamples) == PICO_OK && maxSamples >= (int64_t)sampleCount * channelCount ? 2 : 1;
+        if (segments == 1)
+        {
+            driver.memorySegments(unit.handle, 1, &maxSamples);
+        }
+        driver.setNoOfCaptures(unit.handle, 1);
+
+        CaptureBufferPool pool;
+        pool.configure((size_t)sampleCount, channelMask);
+        BoundedQueue<Capture> queue(4);
+        BLOCK_CONTEXT blockContext;
+        LatencyHistogram readoutLatency("Readout (data ready to queued)");
+        LatencyHistogram consumerLatency("Queue (queued to consumed)");
+
+        // Consumer: touches every sample, as the writer would, and checks that no capture is missing
+        uint64_t consumed = 0;
+        uint64_t missing = 0;
+        int64_t checksum = 0;
+        std::thread consumer([&]
+        {
+            Capture capture;
+            while (queue.pop(capture, std::chrono::milliseconds(100)) || !queue.isClosed())
+            {
+                if (!capture.samples)
+                {
+                    continue;
+                }
+                consumerLatency.record(Clock::now() - capture.readyTime);
+                missing += capture.index - consumed;
+                consumed = capture.index + 1;
+                for (const std::shared_ptr<CaptureBuffer>& buffer : capture.buffers)
+                {
+                    if (buffer)
+                    {
+                        const int16_t* samples = buffer->data();
+                        for (uint32_t i = 0; i < capture.samples; i++)
+                        {
+                            checksum += samples[i];
+                        }
+                    }
+                }
+                capture = Capture();
+            }
+        });
+
+        std::shared_ptr<CaptureBuffer> buffers[2][MAX_CHANNELS];
+        uint64_t registrations = 0;
+        bool failed = false;
+        int32_t timeIndisposed = 0;
+        auto arm = [&](int slot) -> bool
+        {
+            const uint16_t segment = (uint16_t)(slot % segments);
+            for (int channel = 0; channel < channelCount; channel++)
+            {
+                buffers[slot][channel] = pool.acquire(pool.registeredBuffer(segment, channel));
+                if (pool.needsRegistration(segment, channel, buffers[slot][channel].get()))
+                {
+                    registrations++;
+                    PICO_STATUS status = segments > 1
+                        ? driver.setDataBufferBulk(unit.handle, (PS4000_CHANNEL)channel, buffers[slot][channel]->data(), sampleCount, segment)
+                        : driver.setDataBuffer(unit.handle, (PS4000_CHANNEL)channel, buffers[slot][channel]->data(), sampleCount);
+                    if (!check(status, "setDataBuffer"))
+                    {
+                        return false;
+                    }
+                }
+            }
+            blockContext.reset();
+            return check(driver.runBlock(unit.handle, 0, sampleCount, timebase, 1, &timeIndisposed, segment, blockReady, &blockContext), "runBlock");
+        };
+
+        const Clock::time_point start = Clock::now();
+        int current = 0;
+        uint64_t index = 0;
+        bool armed = arm(current);
+        failed = !armed;
+        while (armed && index < captures)
+        {
+            if (!blockContext.wait(std::chrono::milliseconds(5000)) || !check(blockContext.status, "block ready"))
+            {
+                failed = true;
+                break;
+            }
+            uint32_t nSamples = (uint32_t)sampleCount;
+            int16_t overflow = 0;
+            PICO_STATUS status = segments > 1
+                ? driver.getValuesBulk(unit.handle, &nSamples, (uint16_t)current, (uint16_t)current, &overflow)
+                : driver.getValues(unit.handle, 0, &nSamples, 1, RATIO_MODE_NONE, 0, NULL);
+            if (!check(status, "getValues"))
+            {
+                failed = true;
+                break;
+            }
+
+            Capture capture;
+            capture.samples = (std::min)(nSamples, (uint32_t)sampleCount);
+            capture.index = index++;
+            for (int channel = 0; channel < channelCount; channel++)
+            {
+                capture.buffers[channel] = std::move(buffers[current][channel]);
+            }
+
+            armed = false;
+            if (index < captures)
+            {
+                current = 1 - current;
+                armed = arm(current);
+                failed = !armed;
+            }
+            capture.readyTime = Clock::now();
+            readoutLatency.record(capture.readyTime - blockContext.readyAt);
+            while (!queue.push(capture, std::chrono::milliseconds(100)))
+            {
+            }
+        }
+        driver.stop(unit.handle);
+        queue.close();
+        consumer.join();
+        const double elapsed = secondsSince(start);
+        driver.closeUnit(unit.handle);
+
+        missing += index - consumed;
+        const double samples = (double)index * sampleCount * channelCount;
+        printf("Block: %llu captures of %d samples x %d channels (%d ns), %u segment(s)\n",
+            (unsigned long long)index, (int)sampleCount, channelCount, (int)timeInterval, (unsigned)segments);
+        printf("  %.3f s, %.1f captures/s, %.2f MS/s, %.1f MB/s\n", elapsed, index / elapsed, samples / elapsed / 1e6, samples * 2 / elapsed / 1e6);
+        printf("  %llu buffer registrations, %zu pooled buffers, %llu captures missing (checksum %lld)\n",
+            (unsigned long long)registrations, pool.allocatedCount(), (unsigned long long)missing, (long long)checksum);
+        printf("%s\n%s\n", readoutLatency.toString().c_str(), consumerLatency.toString().c_str());
+        return failed || missing ? 1 : 0;
+    }
+
+    struct StreamContext
+    {
+        int16_t* driverBuffer = nullptr;
+        RingBuffer<int16_t>* ring = nullptr;
+        bool autoStop = false;
+        bool ready = false;
+        uint32_t overflows = 0;
+    };
+
+    // Same as CallBackStreaming for a single ring buffer on channel A
+    void PREF4 streamingReady(int16_t handle, int32_t noOfSamples, uint32_t startIndex, int16_t overflow,
+        uint32_t triggerAt, int16_t triggered, int16_t autoStop, void* pParameter)
+    {
+        StreamContext* context = (StreamContext*)pParameter;
+        context->overflows += overflow ? 1 : 0;
+        if (noOfSamples)
+        {
+            context->ring->push(&context->driverBuffer[startIndex], (size_t)noOfSamples);
+        }
+        context->autoStop = autoStop != 0;
+        context->ready = true;
+    }
+
+    int streamBenchmark(int32_t overviewSize, uint32_t totalSamples)
+    {
+        SimulatedScopeDriver::Settings settings;
+        settings.realTime = false;
+        SimulatedScopeDriver driver(settings);
+        UNIT_MODEL unit;
+        if (!openUnit(driver, unit, 1))
+        {
+            return 1;
+        }
+        struct tTriggerDirections directions;
+        struct tPwq pulseWidth;
+        memset(&directions, 0, sizeof(struct tTriggerDirections));
+        memset(&pulseWidth, 0, sizeof(struct tPwq));
+        driver.setTrigger(unit.handle, NULL, 0, NULL, 0, &directions, &pulseWidth, 0, 0, 0);
+        int32_t maxSamples = 0;
+        driver.memorySegments(unit.handle, 1, &maxSamples);
+        int32_t timeInterval = 0;
+        findTimebase(driver, unit.handle, overviewSize, timeInterval);
+
+        std::vector<int16_t> maxBuffer((size_t)overviewSize);
+        std::vector<int16_t> minBuffer((size_t)overviewSize);
+        if (!check(driver.setDataBuffers(unit.handle, PS4000_CHANNEL_A, maxBuffer.data(), minBuffer.data(), overviewSize), "setDataBuffers"))
+        {
+            return 1;
+        }
+        RingBuffer<int16_t> ring((size_t)overviewSize * 8);
+        StreamContext context;
+        context.driverBuffer = maxBuffer.data();
+        context.ring = &ring;
+
+        // Drain: pops in chunks like PicoScope::streamDrain and counts the gaps left by a full ring
+        std::atomic<bool> producing{ true };
+        uint64_t drained = 0;
+        uint64_t gaps = 0;
+        std::thread drain([&]
+        {
+            std::vector<int16_t> chunk(65536);
+            uint64_t expected = 0;
+            while (true)
+            {
+                const bool last = !producing.load();
+                uint64_t firstIndex = 0;
+                const size_t n = ring.pop(chunk.data(), chunk.size(), firstIndex);
+                if (n == 0)
+                {
+                    if (last)
+                    {
+                        break;
+                    }
+                    std::this_thread::yield();
+                    continue;
+                }
+                gaps += firstIndex != expected ? 1 : 0;
+                expected = firstIndex + n;
+                drained += n;
+            }
+        });
+
+        uint32_t sampleInterval = (uint32_t)timeInterval;
+        const Clock::time_point start = Clock::now();
+        bool failed = !check(driver.runStreaming(unit.handle, &sampleInterval, PS4000_NS, 0, totalSamples, 1, 1, (uint32_t)overviewSize), "runStreaming");
+        uint64_t calls = 0;
+        while (!failed && !context.autoStop)
+        {
+            context.ready = false;
+            PICO_STATUS status = driver.getStreamingLatestValues(unit.handle, streamingReady, &context);
+            calls++;
+            if (status != PICO_OK && status != PICO_BUSY)
+            {
+                failed = !check(status, "getStreamingLatestValues");
+            }
+            else if (!context.ready)
+            {
+                std::this_thread::yield();
+            }
+        }
+        driver.stop(unit.handle);
+        producing = false;
+        drain.join();
+        const double elapsed = secondsSince(start);
+        driver.closeUnit(unit.handle);
+
+        printf("Stream: %llu samples at %d ns, overview buffer %d, ring %zu\n",
+            (unsigned long long)(ring.pushed() + ring.dropped()), (int)sampleInterval, (int)overviewSize, ring.capacity());
+        printf("  %.3f s, %.2f MS/s, %llu driver calls, %llu samples drained\n",
+            elapsed, (ring.pushed() + ring.dropped()) / elapsed / 1e6, (unsigned long long)calls, (unsigned long long)drained);
+        printf("  %llu samples dropped in %llu gaps, %u over-range callbacks\n",
+            (unsigned long long)ring.dropped(), (unsigned long long)gaps, (unsigned)context.overflows);
+        return failed ? 1 : 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        return usage();
+    }
+    const std::string command = argv[1];
+    if (command == "block" && argc <= 5)
+    {
+        const int32_t samples = argc > 2 ? atoi(argv[2]) : 100000;
+        const int captures = argc > 3 ? atoi(argv[3]) : 1000;
+        const int channels = argc > 4 ? atoi(argv[4]) : 1;
+        if (samples <= 0 || captures <= 0 || channels < 1 || channels > MAX_CHANNELS)
+        {
+            return usage();
+        }
+        return blockBenchmark(samples, (uint64_t)captures, channels);
+    }
+    if (command == "stream" && argc <= 4)
+    {
+        const int32_t overview = argc > 2 ? atoi(argv[2]) : 100000;
+        const long long total = argc > 3 ? atoll(argv[3]) : 100000000LL;
+        if (overview <= 0 || total <= 0 || total > UINT32_MAX)
+        {
+            return usage();
+        }
+        return streamBenchmark(overview, (uint32_t)total);
+    }
+    return usage();
+}
@@ -0,0 +1,61 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SCOPEDRIVER_H  // Include guard to prevent multiple inclusions
+#define SCOPEDRIVER_H
+
+#include "ScopeTypes.h"  // For UNIT_MODEL, the trigger structs and the driver callback types, without windows.h or the SDK
+
+// Interface between PicoScope and a 4000-series oscilloscope.
+// The methods mirror the ps4000 API calls PicoScope makes (same arguments, same PICO_STATUS results, and
+// the ready callbacks are invoked the same way), so the acquisition code is identical for every backend.
+// Ps4000Driver talks to the instrument; SimulatedScopeDriver generates the data in software.
+class ScopeDriver
+{
+public:
+    virtual ~ScopeDriver() = default;
+
+    virtual const char* name() const = 0;
+
+    virtual PICO_STATUS openUnit(int16_t* handle) = 0;
+    virtual PICO_STATUS closeUnit(int16_t handle) = 0;
+    virtual void getInfo(UNIT_MODEL* unit) = 0;  // Fills model, channel count and ranges (get_info)
+    virtual void setDefaults(UNIT_MODEL* unit) = 0;  // Applies unit->channelSettings (SetDefaults)
+    virtual PICO_STATUS setTrigger(int16_t handle,
+        struct tTriggerChannelProperties* channelProperties,
+        int16_t nChannelProperties,
+        struct tTriggerConditions* triggerConditions,
+        int16_t nTriggerConditions,
+        TRIGGER_DIRECTIONS* directions,
+        struct tPwq* pwq,
+        uint32_t delay,
+        int16_t auxOutputEnabled,
+        int32_t autoTriggerMs) = 0;  // SetTrigger
+
+    virtual PICO_STATUS getTimebase(int16_t handle, uint32_t timebase, int32_t noSamples, int32_t* timeIntervalNanoseconds,
+        int16_t oversample, int32_t* maxSamples, uint16_t segmentIndex) = 0;
+    virtual PICO_STATUS memorySegments(int16_t handle, uint16_t nSegments, int32_t* nMaxSamples) = 0;
+    virtual PICO_STATUS setNoOfCaptures(int16_t handle, uint16_t nCaptures) = 0;
+    virtual PICO_STATUS getNoOfCaptures(int16_t handle, uint16_t* nCaptures) = 0;
+
+    virtual PICO_STATUS setDataBuffer(int16_t handle, PS4000_CHANNEL channel, int16_t* buffer, int32_t bufferLth) = 0;
+    virtual PICO_STATUS setDataBuffers(int16_t handle, PS4000_CHANNEL channel, int16_t* bufferMax, int16_t* bufferMin, int32_t bufferLth) = 0;
+    virtual PICO_STATUS setDataBufferBulk(int16_t handle, PS4000_CHANNEL channel, int16_t* buffer, int32_t bufferLth, uint16_t waveform) = 0;
+
+    virtual PICO_STATUS runBlock(int16_t handle, int32_t noOfPreTriggerSamples, int32_t noOfPostTriggerSamples, uint32_t timebase,
+        int16_t oversample, int32_t* timeIndisposedMs, uint16_t segmentIndex, ps4000BlockReady lpReady, void* pParameter) = 0;
+    virtual PICO_STATUS getValues(int16_t handle, uint32_t startIndex, uint32_t* noOfSamples, uint32_t downSampleRatio,
+        int16_t downSampleRatioMode, uint16_t segmentIndex, int16_t* overflow) = 0;
+    virtual PICO_STATUS getValuesBulk(int16_t handle, uint32_t* noOfSamples, uint16_t fromSegmentIndex, uint16_t toSegmentIndex, int16_t* overflow) = 0;
+
+    virtual PICO_STATUS runStreaming(int16_t handle, uint32_t* sampleInterval, PS4000_TIME_UNITS sampleIntervalTimeUnits,
+        uint32_t maxPreTriggerSamples, uint32_t maxPostPreTriggerSamples, int16_t autoStop, uint32_t downSampleRatio,
+        uint32_t overviewBufferSize) = 0;
+    virtual PICO_STATUS getStreamingLatestValues(int16_t handle, ps4000StreamingReady lpPs4000Ready, void* pParameter) = 0;
+
+    virtual PICO_STATUS stop(int16_t handle) = 0;
+};
+
+#endif // SCOPEDRIVER_H
@@ -0,0 +1,262 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SCOPETYPES_H  // Include guard to prevent multiple inclusions
+#define SCOPETYPES_H
+
+// Types shared by the ScopeDriver interface, its backends and the acquisition code.
+// Needs neither windows.h nor the Pico SDK: when ps4000Api.h is on the include path its definitions are used,
+// otherwise the few the interface needs are declared here with the same names and values, so the simulated
+// backend and ScopeBenchmark build on any platform.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#if __has_include("ps4000Api.h")
+#include "ps4000Api.h"  // Definitions of ps4000 driver routines
+#else
+typedef uint32_t PICO_STATUS;
+
+#define PICO_OK                      0x00000000UL
+#define PICO_INVALID_HANDLE          0x0000000CUL
+#define PICO_INVALID_PARAMETER       0x0000000DUL
+#define PICO_INVALID_CHANNEL         0x00000010UL
+#define PICO_NULL_PARAMETER          0x00000016UL
+#define PICO_TOO_MANY_SAMPLES        0x0000001DUL
+#define PICO_NO_SAMPLES_AVAILABLE    0x00000025UL
+#define PICO_SEGMENT_OUT_OF_RANGE    0x00000026UL
+#define PICO_BUSY                    0x00000027UL
+
+#define PS4000_MAX_VALUE 32764
+
+typedef enum enChannel
+{
+    PS4000_CHANNEL_A,
+    PS4000_CHANNEL_B,
+    PS4000_CHANNEL_C,
+    PS4000_CHANNEL_D,
+    PS4000_EXTERNAL,
+    PS4000_MAX_CHANNELS = PS4000_EXTERNAL,
+    PS4000_TRIGGER_AUX,
+    PS4000_MAX_TRIGGER_SOURCES
+} PS4000_CHANNEL;
+
+typedef enum enRange
+{
+    PS4000_10MV,
+    PS4000_20MV,
+    PS4000_50MV,
+    PS4000_100MV,
+    PS4000_200MV,
+    PS4000_500MV,
+    PS4000_1V,
+    PS4000_2V,
+    PS4000_5V,
+    PS4000_10V,
+    PS4000_20V,
+    PS4000_50V,
+    PS4000_100V,
+    PS4000_MAX_RANGES
+} PS4000_RANGE;
+
+typedef enum enPS4000TimeUnits
+{
+    PS4000_FS,
+    PS4000_PS,
+    PS4000_NS,
+    PS4000_US,
+    PS4000_MS,
+    PS4000_S,
+    PS4000_MAX_TIME_UNITS
+} PS4000_TIME_UNITS;
+
+typedef enum enRatioMode
+{
+    RATIO_MODE_NONE,
+    RATIO_MODE_AGGREGATE
+} RATIO_MODE;
+
+typedef enum enThresholdMode
+{
+    LEVEL,
+    WINDOW
+} THRESHOLD_MODE;
+
+typedef enum enThresholdDirection
+{
+    ABOVE,
+    BELOW,
+    RISING,
+    FALLING,
+    RISING_OR_FALLING,
+    INSIDE = ABOVE,
+    OUTSIDE = BELOW,
+    ENTER = RISING,
+    EXIT = FALLING,
+    ENTER_OR_EXIT = RISING_OR_FALLING,
+    NONE = RISING
+} THRESHOLD_DIRECTION;
+
+typedef enum enTriggerState
+{
+    CONDITION_DONT_CARE,
+    CONDITION_TRUE,
+    CONDITION_FALSE,
+    CONDITION_MAX
+} TRIGGER_STATE;
+
+typedef enum enPulseWidthType
+{
+    PW_TYPE_NONE,
+    PW_TYPE_LESS_THAN,
+    PW_TYPE_GREATER_THAN,
+    PW_TYPE_IN_RANGE,
+    PW_TYPE_OUT_OF_RANGE
+} PULSE_WIDTH_TYPE;
+
+typedef struct tTriggerConditions
+{
+    enum enTriggerState channelA;
+    enum enTriggerState channelB;
+    enum enTriggerState channelC;
+    enum enTriggerState channelD;
+    enum enTriggerState external;
+    enum enTriggerState aux;
+    enum enTriggerState pulseWidthQualifier;
+} TRIGGER_CONDITIONS;
+
+typedef struct tPwqConditions
+{
+    enum enTriggerState channelA;
+    enum enTriggerState channelB;
+    enum enTriggerState channelC;
+    enum enTriggerState channelD;
+    enum enTriggerState external;
+    enum enTriggerState aux;
+} PWQ_CONDITIONS;
+
+typedef struct tTriggerChannelProperties
+{
+    int16_t thresholdUpper;
+    uint16_t thresholdUpperHysteresis;
+    int16_t thresholdLower;
+    uint16_t thresholdLowerHysteresis;
+    PS4000_CHANNEL channel;
+    THRESHOLD_MODE thresholdMode;
+} TRIGGER_CHANNEL_PROPERTIES;
+
+#ifdef _WIN32
+#define PREF4 __stdcall
+#else
+#define PREF4
+#endif
+
+typedef void (PREF4* ps4000BlockReady)(int16_t handle, PICO_STATUS status, void* pParameter);
+typedef void (PREF4* ps4000StreamingReady)(int16_t handle, int32_t noOfSamples, uint32_t startIndex, int16_t overflow,
+    uint32_t triggerAt, int16_t triggered, int16_t autoStop, void* pParameter);
+#endif
+
+#ifndef PREF4
+#define PREF4 __stdcall
+#endif
+
+#define MAX_CHANNELS	4
+#define DUAL_SCOPE		2
+#define TRIPLE_SCOPE	3
+#define QUAD_SCOPE		4
+
+typedef struct
+{
+    int16_t DCcoupled;
+    int16_t range;
+    int16_t enabled;
+} CHANNEL_SETTINGS;
+
+typedef enum
+{
+    MODEL_NONE = 0,
+    MODEL_PS4223 = 4223,
+    MODEL_PS4224 = 4224,
+    MODEL_PS4423 = 4423,
+    MODEL_PS4424 = 4424,
+    MODEL_PS4226 = 4226,
+    MODEL_PS4227 = 4227,
+    MODEL_PS4262 = 4262
+} MODEL_TYPE;
+
+typedef struct tTriggerDirections
+{
+    enum enThresholdDirection channelA;
+    enum enThresholdDirection channelB;
+    enum enThresholdDirection channelC;
+    enum enThresholdDirection channelD;
+    enum enThresholdDirection ext;
+    enum enThresholdDirection aux;
+} TRIGGER_DIRECTIONS;
+
+typedef struct tPwq
+{
+    struct tPwqConditions* conditions;
+    int16_t nConditions;
+    enum enThresholdDirection direction;
+    uint32_t lower;
+    uint32_t upper;
+    enum enPulseWidthType type;
+} PWQ;
+
+typedef struct
+{
+    int16_t					handle;
+    MODEL_TYPE				model;
+    PS4000_RANGE			firstRange;
+    PS4000_RANGE			lastRange;
+    uint16_t				signalGenerator;
+    uint16_t 				ETS;
+    int16_t					channelCount;
+    CHANNEL_SETTINGS		channelSettings[MAX_CHANNELS];
+    PS4000_RANGE			triggerRange;
+} UNIT_MODEL;
+
+/* Per-capture completion context, passed to ps4000RunBlock as pParameter.
+ * The block-ready callback calls signal() and wakes the thread waiting in wait(). */
+typedef struct tBlockContext
+{
+	std::mutex mutex;
+	std::condition_variable readyCondition;
+	bool ready = false;
+	PICO_STATUS status = PICO_OK;
+	std::chrono::steady_clock::time_point readyAt;	// When the block-ready callback ran
+
+	// Prepares the context for the next capture
+	void reset()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ready = false;
+		status = PICO_OK;
+	}
+
+	// Called from the driver's block-ready callback
+	void signal(PICO_STATUS result)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			status = result;
+			readyAt = std::chrono::steady_clock::now();
+			ready = true;
+		}
+		readyCondition.notify_all();
+	}
+
+	// Returns true once the callback has fired, false on a timeout
+	bool wait(std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return readyCondition.wait_for(lock, timeout, [this] { return ready; });
+	}
+} BLOCK_CONTEXT;
+
+#endif // SCOPETYPES_H
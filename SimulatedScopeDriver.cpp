@@ -0,0 +1,673 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+// Built without the precompiled header so that ScopeBenchmark can share it without Qt or windows.h
+#include "SimulatedScopeDriver.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+
+namespace
+{
+    const double pi = 3.14159265358979323846;
+    const double forever = std::numeric_limits<double>::infinity();
+    const uint16_t rangeMillivolts[PS4000_MAX_RANGES] = { 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000 };  // inputRanges of ps4000.cpp
+
+    uint64_t splitMix64(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+}
+
+SimulatedScopeDriver::SimulatedScopeDriver(const Settings& settings) : settings(settings), noiseTable(65536)
+{
+    std::mt19937 generator(settings.seed);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    for (float& value : noiseTable)
+    {
+        value = normal(generator);
+    }
+    noiseState = settings.seed ? settings.seed : 1;
+    memory.assign(1, Segment());
+}
+
+SimulatedScopeDriver::~SimulatedScopeDriver()
+{
+    stop(openHandle);
+}
+
+// PicoScope 4223/4224/4423/4424: 2^n x 12.5 ns for n <= 2, (n - 1) x 50 ns above
+double SimulatedScopeDriver::sampleIntervalNs(uint32_t timebase)
+{
+    if (timebase <= 2)
+    {
+        return 12.5 * (1 << timebase);
+    }
+    return (timebase - 1.0) * 50.0;
+}
+
+double SimulatedScopeDriver::nowNs()
+{
+    if (settings.realTime)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - openedAt).count();
+    }
+    return virtualNowNs;
+}
+
+float SimulatedScopeDriver::nextNoise()
+{
+    // xorshift32 picking from the precomputed Gaussian table
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return noiseTable[noiseState & 0xFFFF];
+}
+
+double SimulatedScopeDriver::burstStartNs(int64_t burst)
+{
+    const double periodNs = 1e9 / (std::max)(settings.prfHz, 1e-3);
+    const float jitter = noiseTable[splitMix64((uint64_t)burst ^ settings.seed) & 0xFFFF];  // Same jitter every time burst is asked for
+    return burst * periodNs + jitter * settings.triggerJitterNs;
+}
+
+double SimulatedScopeDriver::signalMv(int channel, double tNs, double burstStart) const
+{
+    const double periodNs = 1e9 / (std::max)(settings.prfHz, 1e-3);
+    const double durationNs = settings.pulseDurationS * 1e9;
+    double tau = std::fmod(tNs - burstStart - settings.channelDelayNs[channel], periodNs);
+    if (tau < 0)
+    {
+        tau += periodNs;  // Tail of the previous burst
+    }
+    if (tau >= durationNs)
+    {
+        return 0;
+    }
+
+    // Raised-cosine rise and fall, as a transducer ringing up and down
+    const double riseNs = (std::min)(settings.riseCycles * 1e9 / (std::max)(settings.carrierHz, 1.0), durationNs / 2);
+    double envelope = 1;
+    if (riseNs > 0 && tau < riseNs)
+    {
+        envelope = 0.5 * (1 - std::cos(pi * tau / riseNs));
+    }
+    else if (riseNs > 0 && durationNs - tau < riseNs)
+    {
+        envelope = 0.5 * (1 - std::cos(pi * (durationNs - tau) / riseNs));
+    }
+    return settings.amplitudeMv * settings.channelGain[channel] * envelope * std::sin(2 * pi * settings.carrierHz * tau * 1e-9);
+}
+
+int16_t SimulatedScopeDriver::toCounts(int channel, double mv, int16_t& overflow)
+{
+    double counts = std::round(mv * PS4000_MAX_VALUE / rangeMillivolts[channels[channel].range]);
+    if (counts > PS4000_MAX_VALUE || counts < -PS4000_MAX_VALUE)
+    {
+        overflow |= (int16_t)(1 << channel);
+        counts = counts > 0 ? PS4000_MAX_VALUE : -PS4000_MAX_VALUE;
+    }
+    return (int16_t)counts;
+}
+
+PICO_STATUS SimulatedScopeDriver::openUnit(int16_t* handle)
+{
+    if (!handle)
+    {
+        return PICO_NULL_PARAMETER;
+    }
+    openHandle = 1;
+    *handle = openHandle;
+    openedAt = std::chrono::steady_clock::now();
+    virtualNowNs = 0;
+    segmentCount = 1;
+    captureCount = 1;
+    memory.assign(1, Segment());
+    triggerEnabled = false;
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::closeUnit(int16_t handle)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    stop(handle);
+    openHandle = 0;
+    return PICO_OK;
+}
+
+void SimulatedScopeDriver::getInfo(UNIT_MODEL* unit)
+{
+    unit->model = MODEL_PS4424;
+    unit->signalGenerator = 0;
+    unit->ETS = 0;
+    unit->firstRange = PS4000_50MV;
+    unit->lastRange = PS4000_20V;
+    unit->channelCount = QUAD_SCOPE;
+    printf("Variant Info: %s\n", name());
+}
+
+void SimulatedScopeDriver::setDefaults(UNIT_MODEL* unit)
+{
+    for (int channel = 0; channel < MAX_CHANNELS; channel++)
+    {
+        channels[channel] = unit->channelSettings[channel];
+        if (channel >= unit->channelCount || channels[channel].range < 0 || channels[channel].range >= PS4000_MAX_RANGES)
+        {
+            channels[channel].enabled = 0;
+            channels[channel].range = PS4000_1V;
+        }
+    }
+}
+
+PICO_STATUS SimulatedScopeDriver::setTrigger(int16_t handle, struct tTriggerChannelProperties* channelProperties, int16_t nChannelProperties,
+    struct tTriggerConditions* triggerConditions, int16_t nTriggerConditions, TRIGGER_DIRECTIONS* directions,
+    struct tPwq* pwq, uint32_t delay, int16_t auxOutputEnabled, int32_t autoTriggerMs)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    // Only the simple edge trigger on channel A used by PicoScope is modelled
+    triggerEnabled = nChannelProperties > 0 && channelProperties && channelProperties[0].channel == PS4000_CHANNEL_A &&
+        nTriggerConditions > 0 && triggerConditions && triggerConditions[0].channelA == CONDITION_TRUE;
+    if (triggerEnabled)
+    {
+        triggerRising = !(directions && directions->channelA == FALLING);
+        thresholdCounts = triggerRising ? channelProperties[0].thresholdUpper : channelProperties[0].thresholdLower;
+    }
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::getTimebase(int16_t handle, uint32_t timebase, int32_t noSamples, int32_t* timeIntervalNanoseconds,
+    int16_t oversample, int32_t* maxSamples, uint16_t segmentIndex)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    if (segmentIndex >= segmentCount)
+    {
+        return PICO_SEGMENT_OUT_OF_RANGE;
+    }
+    const int32_t perSegment = settings.memorySamples / segmentCount;
+    if (noSamples > perSegment)
+    {
+        return PICO_TOO_MANY_SAMPLES;
+    }
+    if (timeIntervalNanoseconds)
+    {
+        *timeIntervalNanoseconds = (int32_t)sampleIntervalNs(timebase);
+    }
+    if (maxSamples)
+    {
+        *maxSamples = perSegment;
+    }
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::memorySegments(int16_t handle, uint16_t nSegments, int32_t* nMaxSamples)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    if (nSegments == 0)
+    {
+        return PICO_INVALID_PARAMETER;
+    }
+    segmentCount = nSegments;
+    captureCount = (std::min)(captureCount, segmentCount);
+    memory.assign(nSegments, Segment());
+    for (std::vector<BufferRef>& buffers : bulkBuffers)
+    {
+        buffers.clear();
+    }
+    if (nMaxSamples)
+    {
+        *nMaxSamples = settings.memorySamples / nSegments;
+    }
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::setNoOfCaptures(int16_t handle, uint16_t nCaptures)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    if (nCaptures == 0 || nCaptures > segmentCount)
+    {
+        return PICO_INVALID_PARAMETER;
+    }
+    captureCount = nCaptures;
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::getNoOfCaptures(int16_t handle, uint16_t* nCaptures)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    *nCaptures = completedCaptures;
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::setDataBuffer(int16_t handle, PS4000_CHANNEL channel, int16_t* buffer, int32_t bufferLth)
+{
+    return setDataBuffers(handle, channel, buffer, NULL, bufferLth);
+}
+
+PICO_STATUS SimulatedScopeDriver::setDataBuffers(int16_t handle, PS4000_CHANNEL channel, int16_t* bufferMax, int16_t* bufferMin, int32_t bufferLth)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    if (channel < PS4000_CHANNEL_A || channel >= MAX_CHANNELS)
+    {
+        return PICO_INVALID_CHANNEL;
+    }
+    // Without aggregation min and max are the same samples, so only the max buffer is filled
+    blockBuffers[channel] = { bufferMax, bufferLth };
+    streamBuffers[channel] = { bufferMax, bufferLth };
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::setDataBufferBulk(int16_t handle, PS4000_CHANNEL channel, int16_t* buffer, int32_t bufferLth, uint16_t waveform)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    if (channel < PS4000_CHANNEL_A || channel >= MAX_CHANNELS)
+    {
+        return PICO_INVALID_CHANNEL;
+    }
+    if (waveform >= segmentCount)
+    {
+        return PICO_SEGMENT_OUT_OF_RANGE;
+    }
+    if (bulkBuffers[channel].size() <= waveform)
+    {
+        bulkBuffers[channel].resize(waveform + 1);
+    }
+    bulkBuffers[channel][waveform] = { buffer, bufferLth };
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::runBlock(int16_t handle, int32_t noOfPreTriggerSamples, int32_t noOfPostTriggerSamples, uint32_t timebase,
+    int16_t oversample, int32_t* timeIndisposedMs, uint16_t segmentIndex, ps4000BlockReady lpReady, void* pParameter)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    if (noOfPreTriggerSamples < 0 || noOfPostTriggerSamples < 0)
+    {
+        return PICO_INVALID_PARAMETER;
+    }
+    if ((int)segmentIndex + captureCount > segmentCount)
+    {
+        return PICO_SEGMENT_OUT_OF_RANGE;
+    }
+    if ((int64_t)noOfPreTriggerSamples + noOfPostTriggerSamples > settings.memorySamples / segmentCount)
+    {
+        return PICO_TOO_MANY_SAMPLES;
+    }
+    if (captureThread.joinable())
+    {
+        captureThread.join();  // The previous capture has already reported ready
+    }
+
+    const double intervalNs = sampleIntervalNs(timebase);
+    for (uint16_t segment = segmentIndex; segment < segmentIndex + captureCount; segment++)
+    {
+        memory[segment].captured = false;
+    }
+    if (timeIndisposedMs)
+    {
+        *timeIndisposedMs = (int32_t)((noOfPreTriggerSamples + noOfPostTriggerSamples) * intervalNs * captureCount / 1e6);
+    }
+    completedCaptures = 0;
+    stopRequested = false;
+    captureThread = std::thread(&SimulatedScopeDriver::captureLoop, this, segmentIndex, noOfPreTriggerSamples, noOfPostTriggerSamples,
+        intervalNs, lpReady, pParameter);
+    return PICO_OK;
+}
+
+bool SimulatedScopeDriver::waitUntil(double tNs)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (tNs == forever)
+    {
+        stopCondition.wait(lock, [this] { return stopRequested.load(); });
+        return false;
+    }
+    if (settings.realTime)
+    {
+        auto deadline = openedAt + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::nano>(tNs));
+        stopCondition.wait_until(lock, deadline, [this] { return stopRequested.load(); });
+    }
+    else
+    {
+        virtualNowNs = (std::max)(virtualNowNs, tNs);
+    }
+    return !stopRequested;
+}
+
+// Runs on captureThread: fills captureCount segments, one trigger each, then calls lpReady like the driver does
+void SimulatedScopeDriver::captureLoop(uint16_t firstSegment, int32_t preTrigger, int32_t postTrigger, double intervalNs,
+    ps4000BlockReady lpReady, void* pParameter)
+{
+    const double periodNs = 1e9 / (std::max)(settings.prfHz, 1e-3);
+    const double thresholdMv = (double)thresholdCounts * rangeMillivolts[channels[PS4000_CHANNEL_A].range] / PS4000_MAX_VALUE;
+    const double peakMv = settings.amplitudeMv * settings.channelGain[PS4000_CHANNEL_A] + 5 * settings.noiseMv;
+    const bool reachable = channels[PS4000_CHANNEL_A].enabled && std::fabs(thresholdMv) < peakMv;
+
+    for (uint16_t segment = firstSegment; segment < firstSegment + captureCount; segment++)
+    {
+        const double armedNs = nowNs();
+        int64_t burst = (int64_t)std::floor(armedNs / periodNs);
+        double triggerNs = armedNs;
+
+        if (triggerEnabled)
+        {
+            if (!reachable)
+            {
+                waitUntil(forever);  // The trigger level is never crossed; wait like the scope would
+                return;
+            }
+            // First threshold crossing on the sample grid of a burst that starts after arming
+            bool found = false;
+            for (int attempts = 0; attempts < 1000 && !found; attempts++)
+            {
+                while (burstStartNs(burst) < armedNs)
+                {
+                    burst++;
+                }
+                const double start = burstStartNs(burst);
+                const int64_t scanSamples = (int64_t)((settings.pulseDurationS * 1e9) / intervalNs) + 2;
+                double previous = signalMv(PS4000_CHANNEL_A, start, start) + settings.noiseMv * nextNoise();
+                for (int64_t i = 1; i < scanSamples; i++)
+                {
+                    const double t = start + i * intervalNs;
+                    const double value = signalMv(PS4000_CHANNEL_A, t, start) + settings.noiseMv * nextNoise();
+                    if (triggerRising ? (previous < thresholdMv && value >= thresholdMv) : (previous > thresholdMv && value <= thresholdMv))
+                    {
+                        triggerNs = t;
+                        found = true;
+                        break;
+                    }
+                    previous = value;
+                }
+                if (!found)
+                {
+                    burst++;
+                }
+            }
+            if (!found)
+            {
+                waitUntil(forever);
+                return;
+            }
+        }
+
+        // Sample the window around the trigger, then report it once the last sample would have been taken
+        Segment& target = memory[segment];
+        target.overflow = 0;
+        const double burstStart = burstStartNs(burst);
+        for (int channel = 0; channel < MAX_CHANNELS; channel++)
+        {
+            std::vector<int16_t>& samples = target.samples[channel];
+            if (!channels[channel].enabled)
+            {
+                samples.clear();
+                continue;
+            }
+            samples.resize((size_t)preTrigger + postTrigger);
+            for (int32_t i = 0; i < preTrigger + postTrigger; i++)
+            {
+                const double t = triggerNs + (i - preTrigger) * intervalNs;
+                samples[i] = toCounts(channel, signalMv(channel, t, burstStart) + settings.noiseMv * nextNoise(), target.overflow);
+            }
+        }
+        if (!waitUntil(triggerNs + postTrigger * intervalNs))
+        {
+            return;  // Stopped: no ready callback, as with ps4000Stop
+        }
+        target.captured = true;
+        completedCaptures++;
+    }
+
+    if (lpReady)
+    {
+        lpReady(openHandle, PICO_OK, pParameter);
+    }
+}
+
+PICO_STATUS SimulatedScopeDriver::getValues(int16_t handle, uint32_t startIndex, uint32_t* noOfSamples, uint32_t downSampleRatio,
+    int16_t downSampleRatioMode, uint16_t segmentIndex, int16_t* overflow)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    if (!noOfSamples)
+    {
+        return PICO_NULL_PARAMETER;
+    }
+    if (segmentIndex >= segmentCount)
+    {
+        return PICO_SEGMENT_OUT_OF_RANGE;
+    }
+    const Segment& source = memory[segmentIndex];
+    if (!source.captured)
+    {
+        return PICO_NO_SAMPLES_AVAILABLE;
+    }
+
+    // Downsampling is not simulated: every mode returns the raw samples
+    uint32_t copied = 0;
+    for (int channel = 0; channel < MAX_CHANNELS; channel++)
+    {
+        const std::vector<int16_t>& samples = source.samples[channel];
+        const BufferRef& buffer = blockBuffers[channel];
+        if (samples.empty() || !buffer.data || startIndex >= samples.size())
+        {
+            continue;
+        }
+        const uint32_t n = (uint32_t)(std::min)((std::min)((size_t)*noOfSamples, samples.size() - startIndex), (size_t)buffer.length);
+        memcpy(buffer.data, samples.data() + startIndex, n * sizeof(int16_t));
+        copied = (std::max)(copied, n);
+    }
+    *noOfSamples = copied;
+    if (overflow)
+    {
+        *overflow = source.overflow;
+    }
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::getValuesBulk(int16_t handle, uint32_t* noOfSamples, uint16_t fromSegmentIndex, uint16_t toSegmentIndex, int16_t* overflow)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    if (!noOfSamples)
+    {
+        return PICO_NULL_PARAMETER;
+    }
+    if (fromSegmentIndex > toSegmentIndex || toSegmentIndex >= segmentCount)
+    {
+        return PICO_SEGMENT_OUT_OF_RANGE;
+    }
+
+    uint32_t copied = *noOfSamples;
+    for (uint16_t segment = fromSegmentIndex; segment <= toSegmentIndex; segment++)
+    {
+        const Segment& source = memory[segment];
+        if (!source.captured)
+        {
+            return PICO_NO_SAMPLES_AVAILABLE;
+        }
+        for (int channel = 0; channel < MAX_CHANNELS; channel++)
+        {
+            const std::vector<int16_t>& samples = source.samples[channel];
+            if (samples.empty() || bulkBuffers[channel].size() <= segment || !bulkBuffers[channel][segment].data)
+            {
+                continue;
+            }
+            const BufferRef& buffer = bulkBuffers[channel][segment];
+            const uint32_t n = (uint32_t)(std::min)((std::min)((size_t)*noOfSamples, samples.size()), (size_t)buffer.length);
+            memcpy(buffer.data, samples.data(), n * sizeof(int16_t));
+            copied = (std::min)(copied, n);
+        }
+        if (overflow)
+        {
+            overflow[segment - fromSegmentIndex] = source.overflow;
+        }
+    }
+    *noOfSamples = copied;
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::runStreaming(int16_t handle, uint32_t* sampleInterval, PS4000_TIME_UNITS sampleIntervalTimeUnits,
+    uint32_t maxPreTriggerSamples, uint32_t maxPostPreTriggerSamples, int16_t autoStop, uint32_t downSampleRatio,
+    uint32_t overviewBufferSize)
+{
+    static const double unitNs[] = { 1e-6, 1e-3, 1.0, 1e3, 1e6, 1e9 };  // PS4000_FS ... PS4000_S
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    if (!sampleInterval || sampleIntervalTimeUnits < PS4000_FS || sampleIntervalTimeUnits > PS4000_S || overviewBufferSize == 0)
+    {
+        return PICO_INVALID_PARAMETER;
+    }
+    if (captureThread.joinable())
+    {
+        captureThread.join();
+    }
+
+    // The interval is rounded up to what the timebase table can do, and reported back like the driver does
+    const double requestedNs = *sampleInterval * unitNs[sampleIntervalTimeUnits];
+    uint32_t timebase = 0;
+    while (sampleIntervalNs(timebase) < requestedNs && timebase < UINT32_MAX)
+    {
+        timebase++;
+    }
+    streamIntervalNs = sampleIntervalNs(timebase);
+    *sampleInterval = (uint32_t)std::ceil(streamIntervalNs / unitNs[sampleIntervalTimeUnits]);
+
+    streamTotal = (uint64_t)maxPreTriggerSamples + maxPostPreTriggerSamples;
+    streamAutoStop = autoStop != 0;
+    streamCount = 0;
+    overviewSize = overviewBufferSize;
+    overviewPos = 0;
+    streamStartNs = nowNs();
+    streamBurst = (int64_t)std::floor(streamStartNs * (std::max)(settings.prfHz, 1e-3) / 1e9) - 1;
+    streamBurstStart = burstStartNs(streamBurst);
+    stopRequested = false;
+    streaming = true;
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::getStreamingLatestValues(int16_t handle, ps4000StreamingReady lpPs4000Ready, void* pParameter)
+{
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    if (!streaming)
+    {
+        return PICO_INVALID_PARAMETER;
+    }
+
+    const bool finished = streamAutoStop && streamCount >= streamTotal;
+    uint64_t available;
+    if (settings.realTime)
+    {
+        const double elapsed = nowNs() - streamStartNs;
+        const uint64_t generated = elapsed > 0 ? (uint64_t)(elapsed / streamIntervalNs) : 0;
+        available = generated > streamCount ? generated - streamCount : 0;
+    }
+    else
+    {
+        available = overviewSize;
+    }
+    if (streamAutoStop)
+    {
+        available = (std::min)(available, streamTotal - (std::min)(streamCount, streamTotal));
+    }
+    const uint32_t n = (uint32_t)(std::min)(available, (uint64_t)(overviewSize - overviewPos));  // Contiguous in the overview buffer
+    if (n == 0 && !finished)
+    {
+        return PICO_BUSY;
+    }
+
+    int16_t overflow = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const double t = streamStartNs + (streamCount + i) * streamIntervalNs;
+        while (burstStartNs(streamBurst + 1) <= t)
+        {
+            streamBurst++;
+            streamBurstStart = burstStartNs(streamBurst);
+        }
+        for (int channel = 0; channel < MAX_CHANNELS; channel++)
+        {
+            const BufferRef& buffer = streamBuffers[channel];
+            if (!channels[channel].enabled || !buffer.data || overviewPos + i >= (uint32_t)buffer.length)
+            {
+                continue;
+            }
+            buffer.data[overviewPos + i] = toCounts(channel, signalMv(channel, t, streamBurstStart) + settings.noiseMv * nextNoise(), overflow);
+        }
+    }
+
+    const uint32_t startIndex = overviewPos;
+    streamCount += n;
+    overviewPos = (overviewPos + n) % overviewSize;
+    if (!settings.realTime)
+    {
+        virtualNowNs = streamStartNs + streamCount * streamIntervalNs;
+    }
+    const int16_t autoStopped = streamAutoStop && streamCount >= streamTotal ? 1 : 0;
+    if (lpPs4000Ready)
+    {
+        lpPs4000Ready(handle, (int32_t)n, startIndex, overflow, 0, 0, autoStopped, pParameter);
+    }
+    return PICO_OK;
+}
+
+PICO_STATUS SimulatedScopeDriver::stop(int16_t handle)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    stopCondition.notify_all();
+    if (captureThread.joinable())
+    {
+        captureThread.join();
+    }
+    streaming = false;
+    if (handle != openHandle || openHandle == 0)
+    {
+        return PICO_INVALID_HANDLE;
+    }
+    return PICO_OK;
+}
@@ -0,0 +1,144 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SIMULATEDSCOPEDRIVER_H  // Include guard to prevent multiple inclusions
+#define SIMULATEDSCOPEDRIVER_H
+
+#include "ScopeDriver.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ScopeDriver that behaves like a 4-channel PicoScope 4424 without any hardware.
+// Channel A sees tone bursts (carrier with a raised-cosine envelope) repeating at the PRF plus Gaussian noise;
+// channels B-D see attenuated and delayed copies. Trigger thresholds, pre/post-trigger samples, rapid-block
+// segments, the timebase-to-sample-interval table and streaming with an overview buffer follow the ps4000 API.
+// In real-time mode captures and streams take as long as on the instrument; otherwise they run as fast as possible.
+class SimulatedScopeDriver : public ScopeDriver
+{
+public:
+    struct Settings
+    {
+        double carrierHz = 500e3;  // Burst carrier frequency
+        double amplitudeMv = 100;  // Peak amplitude on channel A
+        double pulseDurationS = 20e-6;  // Length of each burst
+        double prfHz = 100;  // Burst repetition frequency
+        double riseCycles = 3;  // Envelope rise and fall time in carrier cycles
+        double noiseMv = 1;  // RMS noise on every channel
+        double triggerJitterNs = 10;  // RMS jitter of the burst start times
+        double channelGain[MAX_CHANNELS] = { 1.0, 0.5, 0.25, 0.125 };  // Amplitude relative to channel A
+        double channelDelayNs[MAX_CHANNELS] = { 0, 500, 1000, 1500 };  // Arrival delay relative to channel A
+        bool realTime = true;  // false: captures and streams are produced as fast as possible
+        int32_t memorySamples = 32 * 1024 * 1024;  // Capture memory shared by the segments
+        uint32_t seed = 1;
+    };
+
+    SimulatedScopeDriver() : SimulatedScopeDriver(Settings()) {}
+    explicit SimulatedScopeDriver(const Settings& settings);
+    ~SimulatedScopeDriver() override;
+
+    const char* name() const override { return "Simulated PicoScope 4424"; }
+    const Settings& getSettings() const { return settings; }
+
+    PICO_STATUS openUnit(int16_t* handle) override;
+    PICO_STATUS closeUnit(int16_t handle) override;
+    void getInfo(UNIT_MODEL* unit) override;
+    void setDefaults(UNIT_MODEL* unit) override;
+    PICO_STATUS setTrigger(int16_t handle, struct tTriggerChannelProperties* channelProperties, int16_t nChannelProperties,
+        struct tTriggerConditions* triggerConditions, int16_t nTriggerConditions, TRIGGER_DIRECTIONS* directions,
+        struct tPwq* pwq, uint32_t delay, int16_t auxOutputEnabled, int32_t autoTriggerMs) override;
+
+    PICO_STATUS getTimebase(int16_t handle, uint32_t timebase, int32_t noSamples, int32_t* timeIntervalNanoseconds,
+        int16_t oversample, int32_t* maxSamples, uint16_t segmentIndex) override;
+    PICO_STATUS memorySegments(int16_t handle, uint16_t nSegments, int32_t* nMaxSamples) override;
+    PICO_STATUS setNoOfCaptures(int16_t handle, uint16_t nCaptures) override;
+    PICO_STATUS getNoOfCaptures(int16_t handle, uint16_t* nCaptures) override;
+
+    PICO_STATUS setDataBuffer(int16_t handle, PS4000_CHANNEL channel, int16_t* buffer, int32_t bufferLth) override;
+    PICO_STATUS setDataBuffers(int16_t handle, PS4000_CHANNEL channel, int16_t* bufferMax, int16_t* bufferMin, int32_t bufferLth) override;
+    PICO_STATUS setDataBufferBulk(int16_t handle, PS4000_CHANNEL channel, int16_t* buffer, int32_t bufferLth, uint16_t waveform) override;
+
+    PICO_STATUS runBlock(int16_t handle, int32_t noOfPreTriggerSamples, int32_t noOfPostTriggerSamples, uint32_t timebase,
+        int16_t oversample, int32_t* timeIndisposedMs, uint16_t segmentIndex, ps4000BlockReady lpReady, void* pParameter) override;
+    PICO_STATUS getValues(int16_t handle, uint32_t startIndex, uint32_t* noOfSamples, uint32_t downSampleRatio,
+        int16_t downSampleRatioMode, uint16_t segmentIndex, int16_t* overflow) override;
+    PICO_STATUS getValuesBulk(int16_t handle, uint32_t* noOfSamples, uint16_t fromSegmentIndex, uint16_t toSegmentIndex, int16_t* overflow) override;
+
+    PICO_STATUS runStreaming(int16_t handle, uint32_t* sampleInterval, PS4000_TIME_UNITS sampleIntervalTimeUnits,
+        uint32_t maxPreTriggerSamples, uint32_t maxPostPreTriggerSamples, int16_t autoStop, uint32_t downSampleRatio,
+        uint32_t overviewBufferSize) override;
+    PICO_STATUS getStreamingLatestValues(int16_t handle, ps4000StreamingReady lpPs4000Ready, void* pParameter) override;
+
+    PICO_STATUS stop(int16_t handle) override;
+
+    static double sampleIntervalNs(uint32_t timebase);  // PicoScope 4424 timebase table
+
+private:
+    struct BufferRef
+    {
+        int16_t* data = nullptr;
+        int32_t length = 0;
+    };
+
+    struct Segment
+    {
+        std::vector<int16_t> samples[MAX_CHANNELS];  // Empty for disabled channels
+        int16_t overflow = 0;  // Bit per channel
+        bool captured = false;
+    };
+
+    Settings settings;
+    int16_t openHandle = 0;
+    CHANNEL_SETTINGS channels[MAX_CHANNELS] = {};
+
+    // Trigger on channel A: rising or falling through thresholdCounts; none when triggerEnabled is false
+    bool triggerEnabled = false;
+    bool triggerRising = true;
+    int16_t thresholdCounts = 0;
+
+    uint16_t segmentCount = 1;
+    uint16_t captureCount = 1;
+    std::vector<Segment> memory;
+    BufferRef blockBuffers[MAX_CHANNELS];
+    std::vector<BufferRef> bulkBuffers[MAX_CHANNELS];  // Indexed by segment
+
+    // Time base shared by block and streaming: ns since openUnit
+    std::chrono::steady_clock::time_point openedAt;
+    double virtualNowNs = 0;  // Simulation time in max-speed mode
+    double nowNs();
+    std::vector<float> noiseTable;  // Unit-variance Gaussian samples
+    uint32_t noiseState = 1;
+    double burstStartNs(int64_t burst);  // Start of burst number burst including its jitter
+    double signalMv(int channel, double tNs, double burstStart) const;  // Noise free, relative to the burst at burstStart
+    int16_t toCounts(int channel, double mv, int16_t& overflow);
+    float nextNoise();
+
+    // Block capture thread
+    void captureLoop(uint16_t firstSegment, int32_t preTrigger, int32_t postTrigger, double intervalNs, ps4000BlockReady lpReady, void* pParameter);
+    bool waitUntil(double tNs);  // Sleeps until simulation time tNs in real-time mode; false when stopped
+    std::thread captureThread;
+    std::mutex mutex;
+    std::condition_variable stopCondition;
+    std::atomic<bool> stopRequested{ false };
+    std::atomic<uint16_t> completedCaptures{ 0 };
+
+    // Streaming
+    bool streaming = false;
+    double streamIntervalNs = 0;
+    uint64_t streamTotal = 0;  // Samples until autoStop
+    bool streamAutoStop = false;
+    uint64_t streamCount = 0;  // Samples delivered
+    uint32_t overviewSize = 0;
+    uint32_t overviewPos = 0;
+    double streamStartNs = 0;
+    BufferRef streamBuffers[MAX_CHANNELS];
+    double streamBurstStart = 0;
+    int64_t streamBurst = 0;
+};
+
+#endif // SIMULATEDSCOPEDRIVER_H
@@ -0,0 +1,275 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "SpectrumAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+
+static const double pi = 3.14159265358979323846;
+
+RealFFTPlan::RealFFTPlan(size_t length) : n(length), half(length / 2)
+{
+    int bits = 0;
+    while (((size_t)1 << bits) < half)
+    {
+        bits++;
+    }
+    bitReverse.resize(half);
+    for (size_t i = 0; i < half; i++)
+    {
+        uint32_t r = 0;
+        for (int b = 0; b < bits; b++)
+        {
+            r |= (uint32_t)((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse[i] = r;
+    }
+
+    // Computed in double so that long transforms keep their accuracy
+    twiddles.resize((std::max)(half / 2, (size_t)1));
+    for (size_t k = 0; k < twiddles.size(); k++)
+    {
+        twiddles[k] = std::complex<float>(std::polar(1.0, -2 * pi * (double)k / (double)half));
+    }
+    splitTwiddles.resize(half + 1);
+    for (size_t k = 0; k <= half; k++)
+    {
+        splitTwiddles[k] = std::complex<float>(std::polar(1.0, -2 * pi * (double)k / (double)n));
+    }
+}
+
+void RealFFTPlan::transform(const float* in, std::complex<float>* out, std::complex<float>* a) const
+{
+    // Even samples as real part, odd samples as imaginary part, in bit-reversed order
+    for (size_t i = 0; i < half; i++)
+    {
+        a[bitReverse[i]] = std::complex<float>(in[2 * i], in[2 * i + 1]);
+    }
+
+    // Iterative radix-2 decimation in time
+    for (size_t len = 2; len <= half; len <<= 1)
+    {
+        const size_t halfLen = len / 2;
+        const size_t step = half / len;
+        for (size_t i = 0; i < half; i += len)
+        {
+            for (size_t j = 0; j < halfLen; j++)
+            {
+                const std::complex<float> u = a[i + j];
+                const std::complex<float> v = a[i + j + halfLen] * twiddles[j * step];
+                a[i + j] = u + v;
+                a[i + j + halfLen] = u - v;
+            }
+        }
+    }
+
+    // Split the half-size spectrum into the spectra of the even and odd samples and combine them
+    for (size_t k = 0; k <= half; k++)
+    {
+        const std::complex<float> zk = a[k % half];
+        const std::complex<float> zmk = std::conj(a[(half - k) % half]);
+        const std::complex<float> even = 0.5f * (zk + zmk);
+        const std::complex<float> odd = std::complex<float>(0, -0.5f) * (zk - zmk);
+        out[k] = even + splitTwiddles[k] * odd;
+    }
+}
+
+const char* SpectrumAnalyzer::windowName(Window window)
+{
+    switch (window)
+    {
+    case Window::Rectangular: return "Rectangular";
+    case Window::Hann: return "Hann";
+    case Window::Hamming: return "Hamming";
+    case Window::Blackman: return "Blackman";
+    case Window::FlatTop: return "Flat top";
+    }
+    return "";
+}
+
+size_t SpectrumAnalyzer::Spectrum::bins() const
+{
+    for (const std::vector<float>& channel : db)
+    {
+        if (!channel.empty())
+        {
+            return channel.size();
+        }
+    }
+    return 0;
+}
+
+int SpectrumAnalyzer::Spectrum::channelCount() const
+{
+    int n = 0;
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        n += (channelMask >> channel) & 1;
+    }
+    return n;
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    stop();
+}
+
+// Builds the plan and window for length samples unless they are already there
+void SpectrumAnalyzer::prepare(size_t length, Window newWindow)
+{
+    const bool newLength = !plan || plan->length() != length;
+    if (newLength)
+    {
+        plan = std::make_unique<RealFFTPlan>(length);
+        input.resize(length);
+        bins.resize(length / 2 + 1);
+        work.resize(length / 2);
+    }
+    if (newLength || newWindow != planWindow)
+    {
+        coefficients.resize(length);
+        double sum = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            const double x = 2 * pi * (double)i / (double)length;  // Periodic windows
+            double w = 1;
+            switch (newWindow)
+            {
+            case Window::Rectangular: w = 1; break;
+            case Window::Hann: w = 0.5 - 0.5 * cos(x); break;
+            case Window::Hamming: w = 0.54 - 0.46 * cos(x); break;
+            case Window::Blackman: w = 0.42 - 0.5 * cos(x) + 0.08 * cos(2 * x); break;
+            case Window::FlatTop: w = 0.21557895 - 0.41663158 * cos(x) + 0.277263158 * cos(2 * x) - 0.083578947 * cos(3 * x) + 0.006947368 * cos(4 * x); break;
+            }
+            coefficients[i] = (float)w;
+            sum += w;
+        }
+        // Scaled so that a sine of amplitude A shows |X[k]| = A
+        const float gain = (float)(2.0 / sum);
+        for (float& c : coefficients)
+        {
+            c *= gain;
+        }
+        planWindow = newWindow;
+    }
+}
+
+void SpectrumAnalyzer::compute(const PicoCapture& capture, Window newWindow, Spectrum& out)
+{
+    out.channelMask = 0;
+    out.captureIndex = capture.index();
+    size_t length = 4;
+    while (length * 2 <= (std::min)((size_t)capture.size(), maxLength))
+    {
+        length *= 2;
+    }
+    if (capture.size() < length || capture.dt() <= 0)
+    {
+        for (std::vector<float>& channel : out.db)
+        {
+            channel.clear();
+        }
+        return;
+    }
+    prepare(length, newWindow);
+    out.binHz = 1e9 / ((double)capture.dt() * (double)length);
+
+    for (int channel = 0; channel < PicoCapture::maxChannels; channel++)
+    {
+        std::vector<float>& db = out.db[channel];
+        if (!capture.hasChannel(channel))
+        {
+            db.clear();
+            continue;
+        }
+        const int16_t* samples = capture.samples(channel);
+        const float mvPerCount = (float)capture.mvPerCount(channel);
+        for (size_t i = 0; i < length; i++)
+        {
+            input[i] = samples[i] * mvPerCount * coefficients[i];
+        }
+        plan->transform(input.data(), bins.data(), work.data());
+
+        db.resize(bins.size());
+        for (size_t k = 0; k < bins.size(); k++)
+        {
+            float magnitude = std::abs(bins[k]);
+            if (k == 0 || k == bins.size() - 1)
+            {
+                magnitude *= 0.5f;  // DC and Nyquist have no mirrored half
+            }
+            db[k] = 20.0f * log10f((std::max)(magnitude, 1e-10f));
+        }
+        out.channelMask |= 1u << channel;
+    }
+}
+
+void SpectrumAnalyzer::start(const Callback& callback)
+{
+    stop();
+    onResult = callback;
+    stopRequested = false;
+    worker = std::thread(&SpectrumAnalyzer::workerLoop, this);
+}
+
+void SpectrumAnalyzer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+        hasPending = false;
+        pending = PicoCapture();
+    }
+    wake.notify_all();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+void SpectrumAnalyzer::submit(const PicoCapture& capture)
+{
+    if (capture.empty())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hasPending)
+        {
+            skippedCount.fetch_add(1, std::memory_order_relaxed);  // Replaced before the worker got to it
+        }
+        pending = capture;  // Shares the samples
+        hasPending = true;
+    }
+    wake.notify_one();
+}
+
+void SpectrumAnalyzer::workerLoop()
+{
+    while (true)
+    {
+        PicoCapture capture;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopRequested || hasPending; });
+            if (stopRequested)
+            {
+                return;
+            }
+            capture = std::move(pending);
+            pending = PicoCapture();
+            hasPending = false;
+        }
+        compute(capture, window, result);
+        capture = PicoCapture();  // Give the buffer back before the callback runs
+        computedCount.fetch_add(1, std::memory_order_relaxed);
+        if (onResult && result.channelMask)
+        {
+            onResult(result);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SPECTRUMANALYZER_H  // Include guard to prevent multiple inclusions
+#define SPECTRUMANALYZER_H
+
+#include <array>
+#include <atomic>
+#include <complex>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PicoCapture.h"
+
+// Radix-2 FFT of N real samples, computed as an N/2-point complex FFT plus a split step.
+// The bit-reversal table and both twiddle tables are built once per length and reused.
+class RealFFTPlan
+{
+public:
+    explicit RealFFTPlan(size_t length);  // length must be a power of two >= 4
+
+    size_t length() const { return n; }
+
+    // Spectrum bins 0..N/2 of input (N values); work must hold N/2 values and is overwritten
+    void transform(const float* input, std::complex<float>* bins, std::complex<float>* work) const;
+
+private:
+    size_t n;
+    size_t half;  // Size of the complex FFT
+    std::vector<uint32_t> bitReverse;  // Of the half-size indices
+    std::vector<std::complex<float>> twiddles;  // exp(-2 pi i k / half), k < half / 2
+    std::vector<std::complex<float>> splitTwiddles;  // exp(-2 pi i k / n), k <= half
+};
+
+// Magnitude spectrum (dB re 1 mV peak) of every channel of a capture, with a selectable window.
+// compute() can be called directly; start() runs it on a worker thread instead: submit() hands over
+// the newest capture without waiting, a capture still pending when a newer one arrives is skipped,
+// and the result is passed to the callback on the worker thread.
+// The FFT length is the largest power of two <= the capture size (at most maxLength samples, taken
+// from the start of the capture); plans and windows are only rebuilt when the length or window changes.
+class SpectrumAnalyzer
+{
+public:
+    enum class Window { Rectangular, Hann, Hamming, Blackman, FlatTop };
+    static const int windowCount = 5;
+    static const char* windowName(Window window);
+
+    static constexpr size_t maxLength = 1 << 20;
+
+    struct Spectrum
+    {
+        double binHz = 0;  // Frequency step between bins
+        uint32_t channelMask = 0;  // Bit per channel with a spectrum
+        uint64_t captureIndex = 0;
+        std::array<std::vector<float>, PicoCapture::maxChannels> db;  // Bins 0..N/2 per channel
+        size_t bins() const;
+        int channelCount() const;
+    };
+
+    // Receives each result on the worker thread; it may swap the vectors out (they are refilled next time)
+    using Callback = std::function<void(Spectrum& spectrum)>;
+
+    SpectrumAnalyzer() = default;
+    ~SpectrumAnalyzer();
+
+    void compute(const PicoCapture& capture, Window window, Spectrum& out);
+
+    void start(const Callback& callback);  // Starts the worker thread
+    void stop();  // Joins the worker thread; a pending capture is dropped
+    void submit(const PicoCapture& capture);  // Never blocks
+    void setWindow(Window newWindow) { window = newWindow; }
+    Window getWindow() const { return window; }
+    uint64_t computed() const { return computedCount.load(std::memory_order_relaxed); }
+    uint64_t skipped() const { return skippedCount.load(std::memory_order_relaxed); }
+
+private:
+    void prepare(size_t length, Window window);
+    void workerLoop();
+
+    std::unique_ptr<RealFFTPlan> plan;
+    Window planWindow = Window::Rectangular;
+    std::vector<float> coefficients;  // Window, already divided by its coherent gain
+    std::vector<float> input;
+    std::vector<std::complex<float>> bins;
+    std::vector<std::complex<float>> work;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopRequested = false;
+    bool hasPending = false;
+    PicoCapture pending;
+    Callback onResult;
+    Spectrum result;
+    std::atomic<Window> window{ Window::Hann };
+    std::atomic<uint64_t> computedCount{ 0 };
+    std::atomic<uint64_t> skippedCount{ 0 };
+};
+
+#endif // SPECTRUMANALYZER_H
@@ -0,0 +1,77 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#include "stdafx.h"
+#include "SpectrumWaterfall.h"
+#include <algorithm>
+
+SpectrumWaterfall::SpectrumWaterfall(size_t rows, size_t columns) :
+    rowCount(rows ? rows : 1), columnCount(columns ? columns : 1), ring(rowCount * columnCount)
+{
+}
+
+void SpectrumWaterfall::addRow(const std::vector<float>& db, double binHz)
+{
+    const size_t bins = db.size();
+    if (bins == 0)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (bins != rowBins || binHz != rowBinHz)
+    {
+        // Rows of a different frequency axis would not line up
+        head = 0;
+        filled = 0;
+        rowBins = bins;
+        rowBinHz = binHz;
+    }
+
+    float* row = &ring[head * columnCount];
+    for (size_t c = 0; c < columnCount; c++)
+    {
+        const size_t first = c * bins / columnCount;
+        const size_t last = (std::max)((c + 1) * bins / columnCount, first + 1);
+        row[c] = *std::max_element(db.begin() + first, db.begin() + (std::min)(last, bins));
+    }
+    head = (head + 1) % rowCount;
+    filled = (std::min)(filled + 1, rowCount);
+    changes++;
+}
+
+void SpectrumWaterfall::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    head = 0;
+    filled = 0;
+    changes++;
+}
+
+uint64_t SpectrumWaterfall::version() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return changes;
+}
+
+uint64_t SpectrumWaterfall::copyRows(std::vector<float>& cells, double& spanHz, float emptyDb) const
+{
+    cells.resize(ring.size());
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t age = 0; age < rowCount; age++)
+    {
+        float* out = &cells[age * columnCount];
+        if (age < filled)
+        {
+            const size_t row = (head + rowCount - 1 - age) % rowCount;
+            std::copy(&ring[row * columnCount], &ring[row * columnCount] + columnCount, out);
+        }
+        else
+        {
+            std::fill(out, out + columnCount, emptyDb);
+        }
+    }
+    spanHz = rowBinHz * (double)rowBins;
+    return changes;
+}
@@ -0,0 +1,45 @@
+// Author: Soroosh Sanatkhani
+// Columbia University
+// Created: 17 October, 2026
+// Last Modified : 17 October, 2026
+
+#ifndef SPECTRUMWATERFALL_H  // Include guard to prevent multiple inclusions
+#define SPECTRUMWATERFALL_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Fixed ring of spectral rows for a waterfall display. Every spectrum is reduced to a fixed number of
+// columns (the largest bin per column) and written over the oldest row, so memory stays the same however
+// long a run lasts. addRow() is called from the analyzer thread, copyRows() from the GUI.
+// A spectrum with a different bin width or bin count than the previous one restarts the ring.
+class SpectrumWaterfall
+{
+public:
+    explicit SpectrumWaterfall(size_t rows = 256, size_t columns = 512);
+
+    size_t rows() const { return rowCount; }
+    size_t columns() const { return columnCount; }
+
+    void addRow(const std::vector<float>& db, double binHz);
+    void clear();
+    uint64_t version() const;  // Changes with every addRow/clear
+
+    // Copies the ring newest row first into cells (rows() x columns(), row-major; rows not filled yet are
+    // set to emptyDb). Returns the version copied; spanHz is the frequency at the last column's end.
+    uint64_t copyRows(std::vector<float>& cells, double& spanHz, float emptyDb) const;
+
+private:
+    const size_t rowCount;
+    const size_t columnCount;
+    mutable std::mutex mutex;
+    std::vector<float> ring;  // rowCount x columnCount
+    size_t head = 0;  // Row written next
+    size_t filled = 0;
+    double rowBinHz = 0;
+    size_t rowBins = 0;
+    uint64_t changes = 0;
+};
+
+#endif // SPECTRUMWATERFALL_H